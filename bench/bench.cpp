@@ -0,0 +1,308 @@
+// Headless benchmark of each module's process(), which can also check that process() doesn't allocate memory.
+// Built and run with `make bench` or `make check-allocations` (see Makefile), which link the plugin's objects against
+// libRack. Modules are created without widgets, and process() is called directly, as the engine would.
+//
+// usage: bench [options] [module slug...]
+//   -r <rate>       sample rate, in Hz (default 48000)
+//   -c <channels>   channels on each patched input (default 1)
+//   -s <seconds>    length of audio processed by each module (default 2)
+//   -b <frames>     frames per block, over which latency is measured (default 256)
+//   -p <ports>      "patched" (all ports connected), "unpatched" (outputs only) or "both" (default)
+//   -a              count allocations and frees in process(), with params set to random values every block,
+//                   and exit with status 1 if there are any
+//
+// Patched inputs are fed sawtooths of different frequencies on each input (and phases on each channel), so they act
+// as both audio and triggers. "create ms" is the time to construct the module, including its first sample rate
+// change (e.g. building SpringReverb's kernel), and "p99 block us" the 99th percentile of the time taken to process
+// a block. To compare against an earlier revision, check it out and run the same command.
+
+#include <rack.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#if defined ARCH_X64
+#include <pmmintrin.h>
+#endif
+
+using namespace rack;
+
+
+// allocations and frees made by the thread running process(), while it is being timed
+static thread_local bool countingAllocations = false;
+static size_t allocations = 0;
+static size_t frees = 0;
+
+#if defined ARCH_LIN
+// glibc allows malloc to be replaced, and its own implementation is available as __libc_malloc etc. operator new
+// and delete go through malloc and free.
+extern "C" {
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t num, size_t size);
+	void* __libc_realloc(void* ptr, size_t size);
+	void __libc_free(void* ptr);
+
+	void* malloc(size_t size) noexcept {
+		if (countingAllocations) {
+			allocations++;
+		}
+		return __libc_malloc(size);
+	}
+	void* calloc(size_t num, size_t size) noexcept {
+		if (countingAllocations) {
+			allocations++;
+		}
+		return __libc_calloc(num, size);
+	}
+	void* realloc(void* ptr, size_t size) noexcept {
+		if (countingAllocations) {
+			allocations++;
+		}
+		return __libc_realloc(ptr, size);
+	}
+	void free(void* ptr) noexcept {
+		if (countingAllocations && ptr) {
+			frees++;
+		}
+		__libc_free(ptr);
+	}
+}
+#else
+// elsewhere only operator new and delete are replaced, so direct calls to malloc aren't counted (they're not inlined,
+// so the compiler doesn't see malloc paired with delete)
+__attribute__((noinline)) void* operator new(size_t size) {
+	if (countingAllocations) {
+		allocations++;
+	}
+	void* ptr = std::malloc(size ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+	if (countingAllocations && ptr) {
+		frees++;
+	}
+	std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+	operator delete(ptr);
+}
+#endif
+
+
+// as on Rack's engine threads
+static void enableFlushToZero() {
+#if defined ARCH_X64
+	_MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+	_MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#elif defined ARCH_ARM64
+	uint64_t fpcr;
+	__asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+	// FZ bit
+	fpcr |= (1 << 24);
+	__asm__ volatile("msr fpcr, %0" :: "r"(fpcr));
+#endif
+}
+
+
+struct Options {
+	float sampleRate = 48000.f;
+	int channels = 1;
+	float seconds = 2.f;
+	int blockSize = 256;
+	bool testPatched = true;
+	bool testUnpatched = true;
+	bool checkAllocations = false;
+	std::vector<std::string> slugs;
+};
+
+struct Result {
+	double createMs = 0.0;
+	double nsPerSample = 0.0;
+	double samplesPerSecond = 0.0;
+	double p99BlockUs = 0.0;
+	size_t allocations = 0;
+	size_t frees = 0;
+};
+
+
+static Result benchmark(plugin::Model* model, const Options& options, bool patched) {
+	typedef std::chrono::steady_clock Clock;
+	Result result;
+
+	const Clock::time_point createStart = Clock::now();
+	engine::Module* module = model->createModule();
+	result.createMs = std::chrono::duration<double, std::milli>(Clock::now() - createStart).count();
+
+	const int numInputs = module->inputs.size();
+	for (int i = 0; i < numInputs; i++) {
+		module->inputs[i].channels = patched ? options.channels : 0;
+	}
+	// outputs are always connected, as modules may skip the work for outputs that aren't
+	for (engine::Output& output : module->outputs) {
+		output.channels = 1;
+	}
+
+	// a block of voltages for each patched input, indexed by [(i * blockSize + frame) * channels + c], which is
+	// filled before each block is timed
+	std::vector<float> inputBlocks(numInputs * options.blockSize * options.channels);
+	std::vector<float> phases(numInputs, 0.f);
+	uint32_t randomState = 1;
+
+	engine::Module::ProcessArgs args;
+	args.sampleRate = options.sampleRate;
+	args.sampleTime = 1.f / options.sampleRate;
+	args.frame = 0;
+
+	const int numBlocks = std::max(1, (int) std::ceil(options.seconds * options.sampleRate / options.blockSize));
+	std::vector<double> blockTimes(numBlocks);
+	double totalTime = 0.0;
+	allocations = 0;
+	frees = 0;
+
+	for (int block = 0; block < numBlocks; block++) {
+		for (int i = 0; i < numInputs && patched; i++) {
+			const float frequency = 20.f * (i + 1);
+			for (int frame = 0; frame < options.blockSize; frame++) {
+				phases[i] += frequency * args.sampleTime;
+				phases[i] -= std::floor(phases[i]);
+				for (int c = 0; c < options.channels; c++) {
+					const float phase = phases[i] + (float) c / options.channels;
+					inputBlocks[(i * options.blockSize + frame) * options.channels + c] = 10.f * (phase - std::floor(phase)) - 5.f;
+				}
+			}
+		}
+
+		if (options.checkAllocations) {
+			for (size_t p = 0; p < module->params.size(); p++) {
+				engine::ParamQuantity* pq = module->paramQuantities[p];
+				randomState = randomState * 1664525u + 1013904223u;
+				float value = math::rescale(randomState >> 8, 0.f, (float)(1 << 24), pq->getMinValue(), pq->getMaxValue());
+				module->params[p].setValue(pq->snapEnabled ? std::round(value) : value);
+			}
+		}
+
+		countingAllocations = options.checkAllocations;
+		const Clock::time_point blockStart = Clock::now();
+		for (int frame = 0; frame < options.blockSize; frame++) {
+			for (int i = 0; i < numInputs && patched; i++) {
+				std::memcpy(module->inputs[i].voltages, &inputBlocks[(i * options.blockSize + frame) * options.channels], sizeof(float) * options.channels);
+			}
+			module->process(args);
+			args.frame++;
+		}
+		const double blockTime = std::chrono::duration<double>(Clock::now() - blockStart).count();
+		countingAllocations = false;
+
+		blockTimes[block] = blockTime;
+		totalTime += blockTime;
+	}
+
+	const double samples = (double) numBlocks * options.blockSize;
+	result.nsPerSample = 1e9 * totalTime / samples;
+	result.samplesPerSecond = samples / totalTime;
+	std::sort(blockTimes.begin(), blockTimes.end());
+	result.p99BlockUs = 1e6 * blockTimes[(size_t) std::ceil(0.99 * numBlocks) - 1];
+	result.allocations = allocations;
+	result.frees = frees;
+
+	delete module;
+	return result;
+}
+
+
+static void printUsage() {
+	std::fprintf(stderr, "usage: bench [-r rate] [-c channels] [-s seconds] [-b frames] [-p patched|unpatched|both] [-a] [module slug...]\n");
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool hasValue = (i + 1 < argc);
+		if (arg == "-r" && hasValue) {
+			options.sampleRate = std::atof(argv[++i]);
+		}
+		else if (arg == "-c" && hasValue) {
+			options.channels = math::clamp(std::atoi(argv[++i]), 1, PORT_MAX_CHANNELS);
+		}
+		else if (arg == "-s" && hasValue) {
+			options.seconds = std::atof(argv[++i]);
+		}
+		else if (arg == "-b" && hasValue) {
+			options.blockSize = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "-p" && hasValue) {
+			const std::string ports = argv[++i];
+			if (ports != "patched" && ports != "unpatched" && ports != "both") {
+				printUsage();
+				return 2;
+			}
+			options.testPatched = (ports != "unpatched");
+			options.testUnpatched = (ports != "patched");
+		}
+		else if (arg == "-a") {
+			options.checkAllocations = true;
+		}
+		else if (arg[0] != '-') {
+			options.slugs.push_back(arg);
+		}
+		else {
+			printUsage();
+			return 2;
+		}
+	}
+	if (!(options.sampleRate > 0.f)) {
+		printUsage();
+		return 2;
+	}
+
+	random::init();
+	enableFlushToZero();
+	contextSet(new Context);
+	APP->engine = new engine::Engine;
+	APP->engine->setSampleRate(options.sampleRate);
+
+	plugin::Plugin* plugin = new plugin::Plugin;
+	init(plugin);
+
+	std::printf("%.0f Hz, %d channel(s), %.1f s, %d frame blocks\n", options.sampleRate, options.channels, options.seconds, options.blockSize);
+	std::printf("%-20s %-10s %10s %10s %12s %13s", "module", "ports", "create ms", "ns/sample", "samples/s", "p99 block us");
+	if (options.checkAllocations) {
+		std::printf(" %8s %8s", "allocs", "frees");
+	}
+	std::printf("\n");
+
+	bool allocated = false;
+	for (plugin::Model* model : plugin->models) {
+		if (!options.slugs.empty() && std::find(options.slugs.begin(), options.slugs.end(), model->slug) == options.slugs.end()) {
+			continue;
+		}
+
+		for (int patched = 1; patched >= 0; patched--) {
+			if (!(patched ? options.testPatched : options.testUnpatched)) {
+				continue;
+			}
+			const Result result = benchmark(model, options, patched);
+			std::printf("%-20s %-10s %10.2f %10.1f %12.0f %13.1f", model->slug.c_str(), patched ? "patched" : "unpatched",
+			            result.createMs, result.nsPerSample, result.samplesPerSecond, result.p99BlockUs);
+			if (options.checkAllocations) {
+				std::printf(" %8zu %8zu%s", result.allocations, result.frees, (result.allocations || result.frees) ? "  FAIL" : "");
+				allocated |= (result.allocations || result.frees);
+			}
+			std::printf("\n");
+		}
+	}
+
+	return allocated ? 1 : 0;
+}
@@ -1,6 +1,136 @@
 #include "plugin.hpp"
 #include "ChowDSP.hpp"
 
+using simd::float_4;
+
+
+// Piecewise linear waveshaper response, tabulated on a uniform grid over [xMin, xMax] (and constant outside), along
+// with its first and second antiderivatives, which are exact for the piecewise linear response. These are used for
+// antiderivative anti-aliasing (ADAA), see Parker et al., "Reducing the aliasing of nonlinear waveshaping using
+// continuous-time convolution" (DAFx 2016) and Bilbao et al., "Antiderivative antialiasing for memoryless
+// nonlinearities" (IEEE SPL 2017). Antiderivatives are in double precision, as ADAA takes differences of them.
+template <int SIZE>
+struct AntiderivativeTable {
+
+	// y[i] is the response at xMin + i * (xMax - xMin) / (SIZE - 1), antiderivatives are zero at x = 0
+	void build(const float* y, double xMin_, double xMax_) {
+		xMin = xMin_;
+		xMax = xMax_;
+		step = (xMax - xMin) / (SIZE - 1);
+
+		f[0] = y[0];
+		F1[0] = 0.0;
+		F2[0] = 0.0;
+		for (int i = 1; i < SIZE; i++) {
+			f[i] = y[i];
+			F1[i] = F1[i - 1] + step * (f[i - 1] + f[i]) / 2.0;
+			F2[i] = F2[i - 1] + step * F1[i - 1] + step * step * (2.0 * f[i - 1] + f[i]) / 6.0;
+		}
+
+		const double F1AtZero = antiderivative1(0.0);
+		const double F2AtZero = antiderivative2(0.0);
+		for (int i = 0; i < SIZE; i++) {
+			F2[i] -= F2AtZero + F1AtZero * (xMin + i * step);
+			F1[i] -= F1AtZero;
+		}
+	}
+
+	double response(double x) const {
+		double t, slope;
+		const int i = findSegment(x, t, slope);
+		return f[i] + slope * t;
+	}
+
+	double antiderivative1(double x) const {
+		double t, slope;
+		const int i = findSegment(x, t, slope);
+		return F1[i] + t * (f[i] + t * slope / 2.0);
+	}
+
+	double antiderivative2(double x) const {
+		double t, slope;
+		const int i = findSegment(x, t, slope);
+		return F2[i] + t * (F1[i] + t * (f[i] / 2.0 + t * slope / 6.0));
+	}
+
+private:
+
+	// returns the grid point i to expand about, with the offset t = x - x_i and the slope of the response there
+	int findSegment(double x, double& t, double& slope) const {
+		if (x <= xMin) {
+			t = x - xMin;
+			slope = 0.0;
+			return 0;
+		}
+		if (x >= xMax) {
+			t = x - xMax;
+			slope = 0.0;
+			return SIZE - 1;
+		}
+		const int i = std::min((int)((x - xMin) / step), SIZE - 2);
+		t = x - (xMin + i * step);
+		slope = (f[i + 1] - f[i]) / step;
+		return i;
+	}
+
+	double xMin = -1.0, xMax = 1.0, step = 1.0;
+	double f[SIZE] = {}, F1[SIZE] = {}, F2[SIZE] = {};
+};
+
+// State for first or second order ADAA of a single signal through an AntiderivativeTable. First order adds half a
+// sample of delay, second order a full sample.
+struct AntiderivativeAntialiaser {
+
+	void reset() {
+		x1 = x2 = 0.0;
+		ad1 = ad2 = 0.0;
+		d1 = 0.0;
+	}
+
+	template <int SIZE>
+	float processFirstOrder(const AntiderivativeTable<SIZE>& table, float xIn) {
+		const double x = xIn;
+		const double F1 = table.antiderivative1(x);
+		// fall back to the response at the midpoint where the difference is ill-conditioned
+		const double y = (std::abs(x - x1) < TOLERANCE) ? table.response(0.5 * (x + x1)) : (F1 - ad1) / (x - x1);
+
+		x1 = x;
+		ad1 = F1;
+		return y;
+	}
+
+	template <int SIZE>
+	float processSecondOrder(const AntiderivativeTable<SIZE>& table, float xIn) {
+		const double x = xIn;
+		const double F2 = table.antiderivative2(x);
+		const double d = (std::abs(x - x1) < TOLERANCE) ? table.antiderivative1(0.5 * (x + x1)) : (F2 - ad2) / (x - x1);
+
+		double y;
+		if (std::abs(x - x2) < TOLERANCE) {
+			const double xBar = 0.5 * (x + x2);
+			const double delta = xBar - x1;
+			y = (std::abs(delta) < TOLERANCE) ? table.response(0.5 * (xBar + x1))
+			    : (2.0 / delta) * (table.antiderivative1(xBar) + (ad2 - table.antiderivative2(xBar)) / delta);
+		}
+		else {
+			y = 2.0 * (d - d1) / (x - x2);
+		}
+
+		x2 = x1;
+		x1 = x;
+		ad2 = F2;
+		d1 = d;
+		return y;
+	}
+
+private:
+	static constexpr double TOLERANCE = 1e-5;
+
+	double x1 = 0.0, x2 = 0.0;	// previous inputs
+	double ad1 = 0.0, ad2 = 0.0;	// antiderivatives (first or second order) at x1
+	double d1 = 0.0;			// previous first divided difference (second order only)
+};
+
 
 struct ChoppingKinky : Module {
 	enum ParamIds {
@@ -37,20 +167,86 @@ struct ChoppingKinky : Module {
 		CHANNEL_CHOPP,
 		NUM_CHANNELS
 	};
+	enum AntialiasingMode {
+		ANTIALIASING_NONE,	// oversampling only
+		ANTIALIASING_ADAA1,	// first order antiderivative anti-aliasing (plus oversampling)
+		ANTIALIASING_ADAA2,	// second order antiderivative anti-aliasing (plus oversampling)
+		NUM_ANTIALIASING_MODES
+	};
 
-	static const int WAVESHAPE_CACHE_SIZE = 256;
-	float waveshapeA[WAVESHAPE_CACHE_SIZE + 1] = {};
-	float waveshapeBPositive[WAVESHAPE_CACHE_SIZE + 1] = {};
-	float waveshapeBNegative[WAVESHAPE_CACHE_SIZE + 1] = {};
+	// functional form for waveshapers uses a lot of transcendental functions, so we cache
+	// the response in a LUT, which is computed once and shared by all instances
+	struct WaveshaperTables {
+		static const int SIZE = 1024;	// points over [0V, 10V]
+
+		// response at (i - 1) * 10V / (SIZE - 1), i.e. padded by one point at each end for cubic interpolation
+		float a[SIZE + 2] = {};
+		float bPositive[SIZE + 2] = {};
+		float bNegative[SIZE + 2] = {};
+
+		// the same responses over [-10V, 10V] (linearly interpolated), with antiderivatives, for ADAA
+		AntiderivativeTable<2 * SIZE - 1> antiderivativeA;
+		AntiderivativeTable<2 * SIZE - 1> antiderivativeB;
+
+		WaveshaperTables() {
+			for (int i = 0; i < SIZE + 2; ++i) {
+				const float x = (i - 1) * 10.f / (SIZE - 1);
+				a[i] = wavefolderAResponse(x);
+				bPositive[i] = wavefolderBResponse(+x);
+				bNegative[i] = wavefolderBResponse(-x);
+			}
 
-	dsp::SchmittTrigger trigger;
-	bool outputAToChopp = false;
-	float previousA = 0.0;
+			std::vector<float> responseA(2 * SIZE - 1), responseB(2 * SIZE - 1);
+			for (int i = 0; i < SIZE; ++i) {
+				responseA[SIZE - 1 + i] = a[i + 1];
+				responseA[SIZE - 1 - i] = -a[i + 1];
+				responseB[SIZE - 1 + i] = bPositive[i + 1];
+				responseB[SIZE - 1 - i] = bNegative[i + 1];
+			}
+			antiderivativeA.build(responseA.data(), -10.0, 10.0);
+			antiderivativeB.build(responseB.data(), -10.0, 10.0);
+		}
+
+		static const WaveshaperTables& get() {
+			// thread-safe initialisation, on first use
+			static const WaveshaperTables tables;
+			return tables;
+		}
 
-	chowdsp::VariableOversampling<> oversampler[NUM_CHANNELS];
+		// cubic Hermite (Catmull-Rom) interpolation of a padded table, for 0 <= x <= 10V
+		static float interpolate(const float* table, float x) {
+			const float j = x * ((SIZE - 1) / 10.f);
+			const int i = std::min((int) j, SIZE - 2);
+			const float t = j - i;
+			const float y0 = table[i], y1 = table[i + 1], y2 = table[i + 2], y3 = table[i + 3];
+
+			const float c1 = 0.5f * (y2 - y0);
+			const float c2 = y0 - 2.5f * y1 + 2.f * y2 - 0.5f * y3;
+			const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+			return ((c3 * t + c2) * t + c1) * t + y1;
+		}
+	};
+	const WaveshaperTables& waveshaperTables = WaveshaperTables::get();
+
+	// user setting, and the mode in use (settings are changed from the UI thread, and applied in process())
+	AntialiasingMode antialiasingMode = ANTIALIASING_NONE;
+	AntialiasingMode activeAntialiasingMode = ANTIALIASING_NONE;
+	AntiderivativeAntialiaser antialiaserA[PORT_MAX_CHANNELS], antialiaserB[PORT_MAX_CHANNELS];
+
+	// per-voice state, in groups of 4 voices
+	dsp::TSchmittTrigger<float_4> trigger[PORT_MAX_CHANNELS / 4];
+	float_4 outputAToChopp[PORT_MAX_CHANNELS / 4] = {};		// mask
+	float_4 previousA[PORT_MAX_CHANNELS / 4] = {};
+
+	// each of A, B and CHOPP is oversampled for a group of 4 voices at a time, one voice per lane
+	chowdsp::VariableOversampling<4, float_4> oversampler[NUM_CHANNELS][PORT_MAX_CHANNELS / 4];
+	// user settings, and the settings the oversamplers were last reset with
 	int oversamplingIndex = 2; 	// default is 2^oversamplingIndex == x4 oversampling
+	chowdsp::OversamplingFilterType oversamplingFilter = chowdsp::BUTTERWORTH_FILTER;
+	int activeOversamplingIndex = 2;
+	chowdsp::OversamplingFilterType activeOversamplingFilter = chowdsp::BUTTERWORTH_FILTER;
 
-	DCBlocker blockDCFilter;
+	DCBlockerT<2, float_4> blockDCFilter[PORT_MAX_CHANNELS / 4];
 	bool blockDC = false;
 
 	ChoppingKinky() {
@@ -74,8 +270,6 @@ struct ChoppingKinky : Module {
 		configOutput(OUT_A_OUTPUT, "A");
 		configOutput(OUT_B_OUTPUT, "B");
 
-		cacheWaveshaperResponses();
-
 		// calculate up/downsampling rates
 		onSampleRateChange();
 	}
@@ -83,94 +277,138 @@ struct ChoppingKinky : Module {
 	void onSampleRateChange() override {
 		float sampleRate = APP->engine->getSampleRate();
 
-		blockDCFilter.setFrequency(22.05 / sampleRate);
-
-		for (int channel_idx = 0; channel_idx < NUM_CHANNELS; channel_idx++) {
-			oversampler[channel_idx].setOversamplingIndex(oversamplingIndex);
-			oversampler[channel_idx].reset(sampleRate);
+		for (int g = 0; g < PORT_MAX_CHANNELS / 4; g++) {
+			blockDCFilter[g].setFrequency(22.05 / sampleRate);
 		}
-	}
 
-	void process(const ProcessArgs& args) override {
+		applyAntialiasingSettings(sampleRate);
+	}
 
-		float gainA = params[FOLD_A_PARAM].getValue();
-		gainA += params[CV_A_PARAM].getValue() * inputs[CV_A_INPUT].getVoltage() / 10.f;
-		gainA += inputs[VCA_CV_A_INPUT].getVoltage() / 10.f;
-		gainA = std::max(gainA, 0.f);
+	// resets the oversamplers (once each) and antialiasers with the current user settings, doesn't allocate
+	void applyAntialiasingSettings(float sampleRate) {
+		activeOversamplingIndex = oversamplingIndex;
+		activeOversamplingFilter = oversamplingFilter;
+		activeAntialiasingMode = antialiasingMode;
+
+		for (int g = 0; g < PORT_MAX_CHANNELS / 4; g++) {
+			for (int channel_idx = 0; channel_idx < NUM_CHANNELS; channel_idx++) {
+				oversampler[channel_idx][g].setOversamplingIndex(activeOversamplingIndex);
+				oversampler[channel_idx][g].setFilterType(activeOversamplingFilter);
+				oversampler[channel_idx][g].reset(sampleRate);
+			}
+		}
 
-		// CV_B_INPUT is normalled to CV_A_INPUT (input with attenuverter)
-		float gainB = params[FOLD_B_PARAM].getValue();
-		gainB += params[CV_B_PARAM].getValue() * inputs[CV_B_INPUT].getNormalVoltage(inputs[CV_A_INPUT].getVoltage()) / 10.f;
-		gainB += inputs[VCA_CV_B_INPUT].getVoltage() / 10.f;
-		gainB = std::max(gainB, 0.f);
+		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+			antialiaserA[c].reset();
+			antialiaserB[c].reset();
+		}
+	}
 
-		const float inA = inputs[IN_A_INPUT].getVoltageSum();
-		const float inB = inputs[IN_B_INPUT].getNormalVoltage(inputs[IN_A_INPUT].getVoltageSum());
+	void process(const ProcessArgs& args) override {
 
-		// if the CHOPP gate is wired in, do chop logic
-		if (inputs[IN_GATE_INPUT].isConnected()) {
-			// TODO: check rescale?
-			trigger.process(rescale(inputs[IN_GATE_INPUT].getVoltageSum(), 0.1f, 2.f, 0.f, 1.f));
-			outputAToChopp = trigger.isHigh();
+		if (oversamplingIndex != activeOversamplingIndex || oversamplingFilter != activeOversamplingFilter
+		    || antialiasingMode != activeAntialiasingMode) {
+			applyAntialiasingSettings(args.sampleRate);
 		}
-		// else zero-crossing detector on input A switches between A and B
-		else {
-			if (previousA > 0 && inA < 0) {
-				outputAToChopp = false;
-			}
-			else if (previousA < 0 && inA > 0) {
-				outputAToChopp = true;
-			}
+
+		// all inputs are polyphonic, monophonic inputs apply to all voices
+		int channels = 1;
+		for (int i = 0; i < NUM_INPUTS; i++) {
+			channels = std::max(channels, inputs[i].getChannels());
 		}
-		previousA = inA;
+
+		// CV_B_INPUT is normalled to CV_A_INPUT (input with attenuverter), and IN_B_INPUT to IN_A_INPUT
+		Input& cvBInput = inputs[CV_B_INPUT].isConnected() ? inputs[CV_B_INPUT] : inputs[CV_A_INPUT];
+		Input& inBInput = inputs[IN_B_INPUT].isConnected() ? inputs[IN_B_INPUT] : inputs[IN_A_INPUT];
 
 		const bool choppIsRequired = outputs[OUT_CHOPP_OUTPUT].isConnected();
 		const bool aIsRequired = outputs[OUT_A_OUTPUT].isConnected() || choppIsRequired;
 		const bool bIsRequired = outputs[OUT_B_OUTPUT].isConnected() || choppIsRequired;
 
-		if (aIsRequired) {
-			oversampler[CHANNEL_A].upsample(inA * gainA);
-		}
-		if (bIsRequired) {
-			oversampler[CHANNEL_B].upsample(inB * gainB);
-		}
-		if (choppIsRequired) {
-			oversampler[CHANNEL_CHOPP].upsample(outputAToChopp ? 1.f : 0.f);
-		}
-
-		float* osBufferA = oversampler[CHANNEL_A].getOSBuffer();
-		float* osBufferB = oversampler[CHANNEL_B].getOSBuffer();
-		float* osBufferChopp = oversampler[CHANNEL_CHOPP].getOSBuffer();
+		outputs[OUT_A_OUTPUT].setChannels(channels);
+		outputs[OUT_B_OUTPUT].setChannels(channels);
+		outputs[OUT_CHOPP_OUTPUT].setChannels(channels);
+
+		for (int c = 0; c < channels; c += 4) {
+			const int g = c / 4;
+			const int groupChannels = std::min(channels - c, 4);
+
+			float_4 gainA = params[FOLD_A_PARAM].getValue();
+			gainA += params[CV_A_PARAM].getValue() * inputs[CV_A_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f;
+			gainA += inputs[VCA_CV_A_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f;
+			gainA = simd::fmax(gainA, 0.f);
+
+			float_4 gainB = params[FOLD_B_PARAM].getValue();
+			gainB += params[CV_B_PARAM].getValue() * cvBInput.getPolyVoltageSimd<float_4>(c) / 10.f;
+			gainB += inputs[VCA_CV_B_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f;
+			gainB = simd::fmax(gainB, 0.f);
+
+			const float_4 inA = inputs[IN_A_INPUT].getPolyVoltageSimd<float_4>(c);
+			const float_4 inB = inBInput.getPolyVoltageSimd<float_4>(c);
+
+			// if the CHOPP gate is wired in, do chop logic
+			if (inputs[IN_GATE_INPUT].isConnected()) {
+				// TODO: check rescale?
+				const float_4 gate = inputs[IN_GATE_INPUT].getPolyVoltageSimd<float_4>(c);
+				trigger[g].process((gate - 0.1f) / (2.f - 0.1f));
+				outputAToChopp[g] = trigger[g].isHigh();
+			}
+			// else zero-crossing detector on input A switches between A and B
+			else {
+				outputAToChopp[g] = ifelse((previousA[g] > 0.f) & (inA < 0.f), 0.f, outputAToChopp[g]);
+				outputAToChopp[g] = ifelse((previousA[g] < 0.f) & (inA > 0.f), float_4::mask(), outputAToChopp[g]);
+			}
+			previousA[g] = inA;
 
-		for (int i = 0; i < oversampler[0].getOversamplingRatio(); i++) {
 			if (aIsRequired) {
-				//osBufferA[i] = wavefolderAResponse(osBufferA[i]);
-				osBufferA[i] = wavefolderAResponseCached(osBufferA[i]);
+				oversampler[CHANNEL_A][g].upsample(inA * gainA);
 			}
 			if (bIsRequired) {
-				//osBufferB[i] = wavefolderBResponse(osBufferB[i]);
-				osBufferB[i] = wavefolderBResponseCached(osBufferB[i]);
+				oversampler[CHANNEL_B][g].upsample(inB * gainB);
 			}
 			if (choppIsRequired) {
-				osBufferChopp[i] = osBufferChopp[i] * osBufferA[i] + (1.f - osBufferChopp[i]) * osBufferB[i];
+				oversampler[CHANNEL_CHOPP][g].upsample(ifelse(outputAToChopp[g], 1.f, 0.f));
 			}
-		}
 
-		float outA = aIsRequired ? oversampler[CHANNEL_A].downsample() : 0.f;
-		float outB = bIsRequired ? oversampler[CHANNEL_B].downsample() : 0.f;
-		float outChopp = choppIsRequired ? oversampler[CHANNEL_CHOPP].downsample() : 0.f;
+			float_4* osBufferA = oversampler[CHANNEL_A][g].getOSBuffer();
+			float_4* osBufferB = oversampler[CHANNEL_B][g].getOSBuffer();
+			float_4* osBufferChopp = oversampler[CHANNEL_CHOPP][g].getOSBuffer();
+
+			for (int i = 0; i < oversampler[CHANNEL_A][g].getOversamplingRatio(); i++) {
+				// the folders are table lookups, so are applied one voice at a time
+				for (int lane = 0; lane < groupChannels; lane++) {
+					if (aIsRequired) {
+						//osBufferA[i].s[lane] = wavefolderAResponse(osBufferA[i].s[lane]);
+						osBufferA[i].s[lane] = wavefolderA(osBufferA[i].s[lane], c + lane);
+					}
+					if (bIsRequired) {
+						//osBufferB[i].s[lane] = wavefolderBResponse(osBufferB[i].s[lane]);
+						osBufferB[i].s[lane] = wavefolderB(osBufferB[i].s[lane], c + lane);
+					}
+				}
+				if (choppIsRequired) {
+					osBufferChopp[i] = osBufferChopp[i] * osBufferA[i] + (1.f - osBufferChopp[i]) * osBufferB[i];
+				}
+			}
 
-		if (blockDC) {
-			outChopp = blockDCFilter.process(outChopp);
-		}
+			const float_4 outA = aIsRequired ? oversampler[CHANNEL_A][g].downsample() : 0.f;
+			const float_4 outB = bIsRequired ? oversampler[CHANNEL_B][g].downsample() : 0.f;
+			float_4 outChopp = choppIsRequired ? oversampler[CHANNEL_CHOPP][g].downsample() : 0.f;
 
-		outputs[OUT_A_OUTPUT].setVoltage(outA);
-		outputs[OUT_B_OUTPUT].setVoltage(outB);
-		outputs[OUT_CHOPP_OUTPUT].setVoltage(outChopp);
+			if (blockDC) {
+				outChopp = blockDCFilter[g].process(outChopp);
+			}
+
+			outputs[OUT_A_OUTPUT].setVoltageSimd(outA, c);
+			outputs[OUT_B_OUTPUT].setVoltageSimd(outB, c);
+			outputs[OUT_CHOPP_OUTPUT].setVoltageSimd(outChopp, c);
+		}
 
+		// lights show the first voice
 		if (inputs[IN_GATE_INPUT].isConnected()) {
-			lights[LED_A_LIGHT].setSmoothBrightness((float) outputAToChopp, args.sampleTime);
-			lights[LED_B_LIGHT].setSmoothBrightness((float)(!outputAToChopp), args.sampleTime);
+			const bool firstVoiceIsA = simd::movemask(outputAToChopp[0]) & 1;
+			lights[LED_A_LIGHT].setSmoothBrightness((float) firstVoiceIsA, args.sampleTime);
+			lights[LED_B_LIGHT].setSmoothBrightness((float)(!firstVoiceIsA), args.sampleTime);
 		}
 		else {
 			lights[LED_A_LIGHT].setBrightness(0.f);
@@ -178,10 +416,25 @@ struct ChoppingKinky : Module {
 		}
 	}
 
+	float wavefolderA(float x, int voice) {
+		switch (activeAntialiasingMode) {
+			case ANTIALIASING_ADAA1: return antialiaserA[voice].processFirstOrder(waveshaperTables.antiderivativeA, x);
+			case ANTIALIASING_ADAA2: return antialiaserA[voice].processSecondOrder(waveshaperTables.antiderivativeA, x);
+			default: return wavefolderAResponseCached(x);
+		}
+	}
+
+	float wavefolderB(float x, int voice) {
+		switch (activeAntialiasingMode) {
+			case ANTIALIASING_ADAA1: return antialiaserB[voice].processFirstOrder(waveshaperTables.antiderivativeB, x);
+			case ANTIALIASING_ADAA2: return antialiaserB[voice].processSecondOrder(waveshaperTables.antiderivativeB, x);
+			default: return wavefolderBResponseCached(x);
+		}
+	}
+
 	float wavefolderAResponseCached(float x) {
 		if (x >= 0) {
-			float j = rescale(clamp(x, 0.f, 10.f), 0.f, 10.f, 0, WAVESHAPE_CACHE_SIZE - 1);
-			return interpolateLinear(waveshapeA, j);
+			return WaveshaperTables::interpolate(waveshaperTables.a, std::min(x, 10.f));
 		}
 		else {
 			return -wavefolderAResponseCached(-x);
@@ -190,12 +443,10 @@ struct ChoppingKinky : Module {
 
 	float wavefolderBResponseCached(float x) {
 		if (x >= 0) {
-			float j = rescale(clamp(x, 0.f, 10.f), 0.f, 10.f, 0, WAVESHAPE_CACHE_SIZE - 1);
-			return interpolateLinear(waveshapeBPositive, j);
+			return WaveshaperTables::interpolate(waveshaperTables.bPositive, std::min(x, 10.f));
 		}
 		else {
-			float j = rescale(clamp(-x, 0.f, 10.f), 0.f, 10.f, 0, WAVESHAPE_CACHE_SIZE - 1);
-			return interpolateLinear(waveshapeBNegative, j);
+			return WaveshaperTables::interpolate(waveshaperTables.bNegative, std::min(-x, 10.f));
 		}
 	}
 
@@ -272,21 +523,12 @@ struct ChoppingKinky : Module {
 		}
 	}
 
-	// functional form for waveshapers uses a lot of transcendental functions, so we cache
-	// the response in a LUT
-	void cacheWaveshaperResponses() {
-		for (int i = 0; i < WAVESHAPE_CACHE_SIZE; ++i) {
-			float x = rescale(i, 0, WAVESHAPE_CACHE_SIZE - 1, 0.0, 10.f);
-			waveshapeA[i] = wavefolderAResponse(x);
-			waveshapeBPositive[i] = wavefolderBResponse(+x);
-			waveshapeBNegative[i] = wavefolderBResponse(-x);
-		}
-	}
-
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "filterDC", json_boolean(blockDC));
-		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversampler[0].getOversamplingIndex()));
+		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversamplingIndex));
+		json_object_set_new(rootJ, "oversamplingFilter", json_integer(oversamplingFilter));
+		json_object_set_new(rootJ, "antialiasingMode", json_integer(antialiasingMode));
 		return rootJ;
 	}
 
@@ -298,9 +540,19 @@ struct ChoppingKinky : Module {
 
 		json_t* oversamplingIndexJ = json_object_get(rootJ, "oversamplingIndex");
 		if (oversamplingIndexJ) {
-			oversamplingIndex = json_integer_value(oversamplingIndexJ);
-			onSampleRateChange();
+			oversamplingIndex = clamp((int) json_integer_value(oversamplingIndexJ), 0, 4);
+		}
+
+		json_t* oversamplingFilterJ = json_object_get(rootJ, "oversamplingFilter");
+		if (oversamplingFilterJ) {
+			oversamplingFilter = (chowdsp::OversamplingFilterType) clamp((int) json_integer_value(oversamplingFilterJ), 0, chowdsp::NUM_FILTER_TYPES - 1);
 		}
+
+		json_t* antialiasingModeJ = json_object_get(rootJ, "antialiasingMode");
+		if (antialiasingModeJ) {
+			antialiasingMode = (AntialiasingMode) clamp((int) json_integer_value(antialiasingModeJ), 0, NUM_ANTIALIASING_MODES - 1);
+		}
+		// settings are applied in process()
 	}
 };
 
@@ -350,7 +602,6 @@ struct ChoppingKinkyWidget : ModuleWidget {
 			int oversamplingIndex;
 			void onAction(const event::Action& e) override {
 				module->oversamplingIndex = oversamplingIndex;
-				module->onSampleRateChange();
 			}
 		};
 		for (int i = 0; i < 5; i++) {
@@ -360,6 +611,24 @@ struct ChoppingKinkyWidget : ModuleWidget {
 			modeItem->oversamplingIndex = i;
 			menu->addChild(modeItem);
 		}
+
+		menu->addChild(createMenuLabel("Oversampling filter"));
+
+		const std::string filterNames[chowdsp::NUM_FILTER_TYPES] = {"Butterworth", "Halfband (polyphase IIR)"};
+		for (int i = 0; i < chowdsp::NUM_FILTER_TYPES; i++) {
+			menu->addChild(createMenuItem(filterNames[i], CHECKMARK(module->oversamplingFilter == i), [ = ]() {
+				module->oversamplingFilter = (chowdsp::OversamplingFilterType) i;
+			}));
+		}
+
+		menu->addChild(createMenuLabel("Wavefolder anti-aliasing"));
+
+		const std::string antialiasingNames[ChoppingKinky::NUM_ANTIALIASING_MODES] = {"Oversampling only", "1st order ADAA", "2nd order ADAA"};
+		for (int i = 0; i < ChoppingKinky::NUM_ANTIALIASING_MODES; i++) {
+			menu->addChild(createMenuItem(antialiasingNames[i], CHECKMARK(module->antialiasingMode == i), [ = ]() {
+				module->antialiasingMode = (ChoppingKinky::AntialiasingMode) i;
+			}));
+		}
 	}
 };
 
@@ -213,6 +213,25 @@ struct TBiquadFilter : IIRFilter<3, T> {
 			default: break;
 		}
 	}
+
+	/** Processes a block of samples in place. The coefficients and state are held in locals for the
+	duration of the block (the buffer could otherwise alias them), so they can stay in registers. */
+	inline void processBlock(T* buffer, int numSamples) noexcept {
+		const T b0 = this->b[0], b1 = this->b[1], b2 = this->b[2];
+		const T a1 = this->a[1], a2 = this->a[2];
+		T z1 = this->z[1], z2 = this->z[2];
+
+		for (int n = 0; n < numSamples; n++) {
+			const T x = buffer[n];
+			const T y = z1 + x * b0;
+			z1 = z2 + x * b1 - y * a1;
+			z2 = x * b2 - y * a2;
+			buffer[n] = y;
+		}
+
+		this->z[1] = z1;
+		this->z[2] = z2;
+	}
 };
 
 typedef TBiquadFilter<> BiquadFilter;
@@ -221,76 +240,78 @@ typedef TBiquadFilter<> BiquadFilter;
 /**
     High-order filter to be used for anti-aliasing or anti-imaging.
     The template parameter N should be 1/2 the desired filter order.
+    T may be float or a SIMD type (e.g. simd::float_4), to filter several signals at once.
 
     Currently uses an 2*N-th order Butterworth filter.
     source: https://github.com/jatinchowdhury18/ChowDSP-VCV/blob/master/src/shared/AAFilter.hpp
 */
-template<int N>
+template<int N, typename T = float>
 class AAFilter {
 public:
 	AAFilter() = default;
 
-	/** Calculate Q values for a Butterworth filter of a given order */
-	static std::vector<float> calculateButterQs(int order) {
-		const int lim = int (order / 2);
-		std::vector<float> Qs;
-
-		for (int k = 1; k <= lim; ++k) {
-			auto b = -2.0f * std::cos((2.0f * k + order - 1) * 3.14159 / (2.0f * order));
-			Qs.push_back(1.0f / b);
-		}
-
-		std::reverse(Qs.begin(), Qs.end());
-		return Qs;
+	/** Calculate the Q value of section k (1 <= k <= order / 2) of a Butterworth filter of a given order */
+	static float calculateButterQ(int order, int k) {
+		auto b = -2.0f * std::cos((2.0f * k + order - 1) * 3.14159 / (2.0f * order));
+		return 1.0f / b;
 	}
 
 	/**
-	 * Resets the filter to process at a new sample rate.
+	 * Resets the filter to process at a new sample rate. Doesn't allocate, so may be called on the audio thread.
 	 *
 	 * @param sampleRate: The base (i.e. pre-oversampling) sample rate of the audio being processed
 	 * @param osRatio: The oversampling ratio at which the filter is being used
 	 */
 	void reset(float sampleRate, int osRatio) {
 		float fc = 0.98f * (sampleRate / 2.0f);
-		auto Qs = calculateButterQs(2 * N);
 
-		for (int i = 0; i < N; ++i)
-			filters[i].setParameters(BiquadFilter::Type::LOWPASS, fc / (osRatio * sampleRate), Qs[i], 1.0f);
+		for (int i = 0; i < N; ++i) {
+			// sections in order of increasing Q
+			filters[i].setParameters(TBiquadFilter<T>::Type::LOWPASS, fc / (osRatio * sampleRate), calculateButterQ(2 * N, N - i), 1.0f);
+			filters[i].reset();
+		}
 	}
 
-	inline float process(float x) noexcept {
+	inline T process(T x) noexcept {
 		for (int i = 0; i < N; ++i)
 			x = filters[i].process(x);
 
 		return x;
 	}
 
+	/** Filters a block of samples in place, one biquad section at a time */
+	inline void processBlock(T* buffer, int numSamples) noexcept {
+		for (int i = 0; i < N; ++i)
+			filters[i].processBlock(buffer, numSamples);
+	}
+
 private:
-	BiquadFilter filters[N];
+	TBiquadFilter<T> filters[N];
 };
 
 
 /**
- * Base class for oversampling of any order
- * source: https://github.com/jatinchowdhury18/ChowDSP-VCV/blob/master/src/shared/oversampling.hpp
- */
-class BaseOversampling {
-public:
-	BaseOversampling() = default;
-	virtual ~BaseOversampling() {}
-
-	/** Resets the oversampler for processing at some base sample rate */
-	virtual void reset(float /*baseSampleRate*/) = 0;
+    Upsamples numSamples input samples into osBuffer (ratio * numSamples samples) by zero-stuffing, followed by the
+    anti-imaging filter. Shared by the oversamplers below that use `AAFilter`.
+*/
+template<int N, typename T>
+inline void upsampleBlockButterworth(const T* x, int numSamples, T* osBuffer, int ratio, AAFilter<N, T>& aiFilter) noexcept {
+	for (int n = 0; n < numSamples; n++) {
+		osBuffer[n * ratio] = ratio * x[n];
+		std::fill(&osBuffer[n * ratio + 1], &osBuffer[(n + 1) * ratio], T(0.0f));
+	}
 
-	/** Upsample a single input sample and update the oversampled buffer */
-	virtual void upsample(float) noexcept = 0;
+	aiFilter.processBlock(osBuffer, numSamples * ratio);
+}
 
-	/** Output a downsampled output sample from the current oversampled buffer */
-	virtual float downsample() noexcept = 0;
+/** Filters osBuffer (ratio * numSamples samples) in place with the anti-aliasing filter, and decimates it into y */
+template<int N, typename T>
+inline void downsampleBlockButterworth(T* y, int numSamples, T* osBuffer, int ratio, AAFilter<N, T>& aaFilter) noexcept {
+	aaFilter.processBlock(osBuffer, numSamples * ratio);
 
-	/** Returns a pointer to the oversampled buffer */
-	virtual float* getOSBuffer() noexcept = 0;
-};
+	for (int n = 0; n < numSamples; n++)
+		y[n] = osBuffer[n * ratio + ratio - 1];
+}
 
 
 /**
@@ -304,52 +325,290 @@ public:
         oversample.osBuffer[k] = processSample(oversample.osBuffer[k]);
     float y = oversample.downsample();
     @endcode
+
+    T may be float or a SIMD type (e.g. simd::float_4), to oversample several signals at once.
+
+    To process up to maxBlockSize samples at a time, use `upsampleBlock()` and `downsampleBlock()` instead,
+    which hold the oversampled block in osBuffer (ratio * numSamples samples).
 */
-template<int ratio, int filtN = 4>
-class Oversampling : public BaseOversampling {
+template<int ratio, int filtN = 4, typename T = float, int maxBlockSize = 1>
+class Oversampling {
 public:
 	Oversampling() = default;
-	virtual ~Oversampling() {}
 
-	void reset(float baseSampleRate) override {
+	void reset(float baseSampleRate) {
 		aaFilter.reset(baseSampleRate, ratio);
 		aiFilter.reset(baseSampleRate, ratio);
-		std::fill(osBuffer, &osBuffer[ratio], 0.0f);
+		std::fill(osBuffer, &osBuffer[ratio * maxBlockSize], T(0.0f));
+	}
+
+	/** Upsample a single input sample and update the oversampled buffer */
+	inline void upsample(T x) noexcept {
+		upsampleBlock(&x, 1);
+	}
+
+	/** Output a downsampled output sample from the current oversampled buffer (which is filtered in place) */
+	inline T downsample() noexcept {
+		T y;
+		downsampleBlock(&y, 1);
+		return y;
+	}
+
+	/** Upsample numSamples (at most maxBlockSize) input samples into the oversampled buffer */
+	inline void upsampleBlock(const T* x, int numSamples) noexcept {
+		upsampleBlockButterworth(x, numSamples, osBuffer, ratio, aiFilter);
 	}
 
-	inline void upsample(float x) noexcept override {
-		osBuffer[0] = ratio * x;
-		std::fill(&osBuffer[1], &osBuffer[ratio], 0.0f);
+	/** Output numSamples (at most maxBlockSize) downsampled samples from the oversampled buffer (which is filtered in place) */
+	inline void downsampleBlock(T* y, int numSamples) noexcept {
+		downsampleBlockButterworth(y, numSamples, osBuffer, ratio, aaFilter);
+	}
+
+	/** Returns a pointer to the oversampled buffer */
+	inline T* getOSBuffer() noexcept {
+		return osBuffer;
+	}
+
+	T osBuffer[ratio * maxBlockSize];
+
+private:
+	AAFilter<filtN, T> aaFilter; // anti-aliasing filter
+	AAFilter<filtN, T> aiFilter; // anti-imaging filter
+};
+
+
+
+/**
+    Polyphase IIR halfband lowpass filter, for upsampling or downsampling by a factor of 2. The filter is made of two
+    parallel chains of first-order allpass sections, H(z) = (A0(z^2) + z^-1 A1(z^2)) / 2, which run at the lower of
+    the two sample rates, so that no work is spent on the zeros (or discarded samples) of the oversampled signal.
+    A given instance should only be used in one direction, as it holds the filter state.
+
+    The coefficients are those of an elliptic halfband filter, designed as in HIIR by Laurent de Soras
+    (http://ldesoras.free.fr/prod.html#src_hiir). More coefficients give a steeper transition and/or more attenuation.
+*/
+template<int numCoefs, typename T = float>
+class HalfbandFilter {
+public:
+	HalfbandFilter() {
+		setTransitionBandwidth(0.1);
+	}
+
+	/**
+	 * Designs the filter for a given transition bandwidth, normalised to the oversampled sample rate, so that the
+	 * passband extends to (1/4 - transition) and the stopband starts at (1/4 + transition).
+	 */
+	void setTransitionBandwidth(double transition) {
+		const int order = 2 * numCoefs + 1;
+
+		// elliptic modulus and nome for the given transition bandwidth
+		double k = std::tan((1.0 - 2.0 * transition) * M_PI / 4.0);
+		k *= k;
+		const double kksqrt = std::pow(1.0 - k * k, 0.25);
+		const double e = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+		const double e4 = e * e * e * e;
+		const double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+		for (int i = 0; i < numCoefs; i++) {
+			const int c = i + 1;
+
+			double num = 0.0, term = 0.0;
+			for (int j = 0, sign = 1; j == 0 || std::abs(term) > 1e-100; j++, sign = -sign) {
+				term = std::pow(q, j * (j + 1)) * std::sin((2 * j + 1) * c * M_PI / order) * sign;
+				num += term;
+			}
+			num *= std::pow(q, 0.25);
+
+			double den = 0.5;
+			for (int j = 1, sign = -1; j == 1 || std::abs(term) > 1e-100; j++, sign = -sign) {
+				term = std::pow(q, j * j) * std::cos(2 * j * c * M_PI / order) * sign;
+				den += term;
+			}
+
+			const double ww = (num / den) * (num / den);
+			const double x = std::sqrt((1.0 - ww * k) * (1.0 - ww / k)) / (1.0 + ww);
+			coefs[i] = (1.0 - x) / (1.0 + x);
+		}
+	}
 
-		for (int k = 0; k < ratio; k++)
-			osBuffer[k] = aiFilter.process(osBuffer[k]);
+	void reset() {
+		std::fill(x1, &x1[numCoefs], T(0.0f));
+		std::fill(y1, &y1[numCoefs], T(0.0f));
 	}
 
-	inline float downsample() noexcept override {
-		float y = 0.0f;
-		for (int k = 0; k < ratio; k++)
-			y = aaFilter.process(osBuffer[k]);
+	/**
+	 * Upsamples numSamples samples from in to 2 * numSamples samples in out. The buffers may overlap, provided that
+	 * in starts at out + numSamples (i.e. the input is right-aligned in the output buffer).
+	 */
+	inline void upsample(const T* in, T* out, int numSamples) noexcept {
+		for (int n = 0; n < numSamples; n++) {
+			T even = in[n];
+			T odd = even;
+			for (int i = 0; i < numCoefs; i += 2)
+				even = allpass(i, even);
+			for (int i = 1; i < numCoefs; i += 2)
+				odd = allpass(i, odd);
+
+			out[2 * n] = even;
+			out[2 * n + 1] = odd;
+		}
+	}
+
+	/** Downsamples 2 * numSamples samples from in to numSamples samples in out, which may be the same buffer */
+	inline void downsample(const T* in, T* out, int numSamples) noexcept {
+		for (int n = 0; n < numSamples; n++) {
+			T even = in[2 * n + 1];
+			T odd = in[2 * n];
+			for (int i = 0; i < numCoefs; i += 2)
+				even = allpass(i, even);
+			for (int i = 1; i < numCoefs; i += 2)
+				odd = allpass(i, odd);
+
+			out[n] = 0.5f * (even + odd);
+		}
+	}
 
+private:
+	inline T allpass(int i, T x) noexcept {
+		const T y = coefs[i] * (x - y1[i]) + x1[i];
+		x1[i] = x;
+		y1[i] = y;
+		return y;
+	}
+
+	T coefs[numCoefs];
+	T x1[numCoefs] = {};
+	T y1[numCoefs] = {};
+};
+
+
+/**
+    Upsamples numSamples input samples into osBuffer (2^numStages * numSamples samples) with a cascade of halfband
+    filters: first (base rate -> 2x), then later[0] (2x -> 4x), etc. Shared by the oversamplers below that use
+    `HalfbandFilter`.
+*/
+template<typename T, typename FirstFilter, typename LaterFilter>
+inline void upsampleBlockHalfband(const T* x, int numSamples, T* osBuffer, int numStages, FirstFilter& first, LaterFilter* later) noexcept {
+	// each stage reads its input from the end of the buffer, and writes its (twice as long) output ending at the same place
+	const int osSamples = numSamples << numStages;
+	T* in = &osBuffer[osSamples - numSamples];
+	std::copy(x, x + numSamples, in);
+	if (numStages == 0)
+		return;
+
+	first.upsample(in, in - numSamples, numSamples);
+	in -= numSamples;
+	for (int s = 0, n = 2 * numSamples; s < numStages - 1; s++, n *= 2) {
+		later[s].upsample(in, in - n, n);
+		in -= n;
+	}
+}
+
+/** Downsamples osBuffer (2^numStages * numSamples samples, filtered in place) into y, with the cascade as above */
+template<typename T, typename FirstFilter, typename LaterFilter>
+inline void downsampleBlockHalfband(T* y, int numSamples, T* osBuffer, int numStages, FirstFilter& first, LaterFilter* later) noexcept {
+	if (numStages == 0) {
+		std::copy(osBuffer, osBuffer + numSamples, y);
+		return;
+	}
+
+	int n = (numSamples << numStages) / 2;
+	for (int s = numStages - 2; s >= 0; s--, n /= 2)
+		later[s].downsample(osBuffer, osBuffer, n);
+	first.downsample(osBuffer, y, numSamples);
+}
+
+
+/**
+    Class to implement an oversampled process by a factor of 2^numStages, with the same interface as `Oversampling`,
+    but using a cascade of polyphase halfband filters (see `HalfbandFilter`) rather than a Butterworth filter running
+    at the full oversampled rate. The first stage (nearest the base rate) has the sharpest filter, later stages only need
+    to reject images well above the original passband, so are much cheaper. Compared with `Oversampling`, this is cheaper
+    at high oversampling ratios, with a flatter passband and far more alias rejection just above the base Nyquist
+    frequency (though with more phase shift near it).
+*/
+template<int numStages, typename T = float, int maxBlockSize = 1>
+class HalfbandOversampling {
+public:
+	HalfbandOversampling() {
+		// the first stage passband extends to ~0.45 x base sample rate
+		upFirst.setTransitionBandwidth(0.025);
+		downFirst.setTransitionBandwidth(0.025);
+		for (int s = 0; s < NumLaterStages; s++) {
+			upStages[s].setTransitionBandwidth(0.1375);
+			downStages[s].setTransitionBandwidth(0.1375);
+		}
+	}
+
+	/** The filters don't depend on the sample rate, so this only clears their state */
+	void reset(float baseSampleRate) {
+		upFirst.reset();
+		downFirst.reset();
+		for (int s = 0; s < NumLaterStages; s++) {
+			upStages[s].reset();
+			downStages[s].reset();
+		}
+		std::fill(osBuffer, &osBuffer[ratio * maxBlockSize], T(0.0f));
+	}
+
+	/** Upsample a single input sample and update the oversampled buffer */
+	inline void upsample(T x) noexcept {
+		upsampleBlock(&x, 1);
+	}
+
+	/** Output a downsampled output sample from the current oversampled buffer (which is filtered in place) */
+	inline T downsample() noexcept {
+		T y;
+		downsampleBlock(&y, 1);
 		return y;
 	}
 
-	inline float* getOSBuffer() noexcept override {
+	/** Upsample numSamples (at most maxBlockSize) input samples into the oversampled buffer */
+	inline void upsampleBlock(const T* x, int numSamples) noexcept {
+		upsampleBlockHalfband(x, numSamples, osBuffer, numStages, upFirst, upStages);
+	}
+
+	/** Output numSamples (at most maxBlockSize) downsampled samples from the oversampled buffer (which is filtered in place) */
+	inline void downsampleBlock(T* y, int numSamples) noexcept {
+		downsampleBlockHalfband(y, numSamples, osBuffer, numStages, downFirst, downStages);
+	}
+
+	/** Returns a pointer to the oversampled buffer */
+	inline T* getOSBuffer() noexcept {
 		return osBuffer;
 	}
 
-	float osBuffer[ratio];
+	enum {
+		ratio = 1 << numStages
+	};
+
+	T osBuffer[ratio * maxBlockSize];
 
 private:
-	AAFilter<filtN> aaFilter; // anti-aliasing filter
-	AAFilter<filtN> aiFilter; // anti-imaging filter
+	enum {
+		NumLaterStages = numStages > 1 ? numStages - 1 : 1
+	};
+
+	HalfbandFilter<8, T> upFirst, downFirst;                          // base rate <-> 2x
+	HalfbandFilter<4, T> upStages[NumLaterStages], downStages[NumLaterStages]; // 2x <-> 4x, etc.
 };
 
 
 
+/** Filters that `VariableOversampling` can use for anti-imaging and anti-aliasing */
+enum OversamplingFilterType {
+	BUTTERWORTH_FILTER,	// see `Oversampling`
+	HALFBAND_FILTER,	// see `HalfbandOversampling`
+	NUM_FILTER_TYPES
+};
+
 /**
     Class to implement an oversampled process, with variable
     oversampling factor. To use, create an object, set the oversampling
-    factor using `setOversamplingindex()` and prepare using `reset()`.
+    factor using `setOversamplingindex()` (and optionally the filter type
+    using `setFilterType()`) and prepare using `reset()`, which applies
+    the settings. `reset()` doesn't allocate, so settings can be changed
+    on the audio thread (e.g. deferred from the UI thread via a flag).
 
     Then use the following code to process samples:
     @code
@@ -360,42 +619,98 @@ private:
     float y = oversample.downsample();
     @endcode
 
+    T may be float or a SIMD type (e.g. simd::float_4), to oversample several signals at once. As with `Oversampling`,
+    blocks of up to maxBlockSize samples can be processed with `upsampleBlock()` and `downsampleBlock()`.
+
+    Only the state for the current setting is held: a single buffer sized for the highest ratio, and one set of
+    filters (for each filter type), which are re-derived when the oversampling factor changes. This keeps the object
+    small, so the active state stays in cache.
+
 	source (modified): https://github.com/jatinchowdhury18/ChowDSP-VCV/blob/master/src/shared/VariableOversampling.hpp
 */
-template<int filtN = 4>
+template<int filtN = 4, typename T = float, int maxBlockSize = 1>
 class VariableOversampling {
 public:
-	VariableOversampling() = default;
+	VariableOversampling() {
+		upFirst.setTransitionBandwidth(0.025);
+		downFirst.setTransitionBandwidth(0.025);
+		for (int s = 0; s < MaxStages - 1; s++) {
+			upStages[s].setTransitionBandwidth(0.1375);
+			downStages[s].setTransitionBandwidth(0.1375);
+		}
+		reset(sampleRate);
+	}
+
+	/** Prepare the oversampler to process audio at a given sample rate, with the current settings */
+	void reset(float newSampleRate) {
+		sampleRate = newSampleRate;
+		osIdx = nextOsIdx;
+		filterType = nextFilterType;
+
+		aaFilter.reset(sampleRate, getOversamplingRatio());
+		aiFilter.reset(sampleRate, getOversamplingRatio());
 
-	/** Prepare the oversampler to process audio at a given sample rate */
-	void reset(float sampleRate) {
-		for (auto* os : oss)
-			os->reset(sampleRate);
+		upFirst.reset();
+		downFirst.reset();
+		for (int s = 0; s < MaxStages - 1; s++) {
+			upStages[s].reset();
+			downStages[s].reset();
+		}
+
+		std::fill(osBuffer, &osBuffer[MaxRatio * maxBlockSize], T(0.0f));
 	}
 
-	/** Sets the oversampling factor as 2^idx */
+	/** Sets the oversampling factor as 2^idx, which takes effect at the next reset() */
 	void setOversamplingIndex(int newIdx) {
-		osIdx = newIdx;
+		nextOsIdx = std::max(0, std::min(newIdx, (int) MaxStages));
 	}
 
-	/** Returns the oversampling index */
+	/** Returns the oversampling index in use (i.e. as of the last reset()) */
 	int getOversamplingIndex() const noexcept {
 		return osIdx;
 	}
 
+	/** Sets the anti-imaging/anti-aliasing filter type, which takes effect at the next reset() */
+	void setFilterType(OversamplingFilterType newFilterType) {
+		nextFilterType = newFilterType;
+	}
+
+	/** Returns the filter type in use (i.e. as of the last reset()) */
+	OversamplingFilterType getFilterType() const noexcept {
+		return filterType;
+	}
+
 	/** Upsample a single input sample and update the oversampled buffer */
-	inline void upsample(float x) noexcept {
-		oss[osIdx]->upsample(x);
+	inline void upsample(T x) noexcept {
+		upsampleBlock(&x, 1);
 	}
 
 	/** Output a downsampled output sample from the current oversampled buffer */
-	inline float downsample() noexcept {
-		return oss[osIdx]->downsample();
+	inline T downsample() noexcept {
+		T y;
+		downsampleBlock(&y, 1);
+		return y;
+	}
+
+	/** Upsample numSamples (at most maxBlockSize) input samples into the oversampled buffer */
+	inline void upsampleBlock(const T* x, int numSamples) noexcept {
+		if (filterType == HALFBAND_FILTER)
+			upsampleBlockHalfband(x, numSamples, osBuffer, osIdx, upFirst, upStages);
+		else
+			upsampleBlockButterworth(x, numSamples, osBuffer, getOversamplingRatio(), aiFilter);
+	}
+
+	/** Output numSamples (at most maxBlockSize) downsampled samples from the oversampled buffer (which is filtered in place) */
+	inline void downsampleBlock(T* y, int numSamples) noexcept {
+		if (filterType == HALFBAND_FILTER)
+			downsampleBlockHalfband(y, numSamples, osBuffer, osIdx, downFirst, downStages);
+		else
+			downsampleBlockButterworth(y, numSamples, osBuffer, getOversamplingRatio(), aaFilter);
 	}
 
 	/** Returns a pointer to the oversampled buffer */
-	inline float* getOSBuffer() noexcept {
-		return oss[osIdx]->getOSBuffer();
+	inline T* getOSBuffer() noexcept {
+		return osBuffer;
 	}
 
 	/** Returns the current oversampling factor */
@@ -406,17 +721,26 @@ public:
 
 private:
 	enum {
-		NumOS = 5, // number of oversampling options
+		MaxStages = 4, // i.e. up to 16x
+		MaxRatio = 1 << MaxStages
 	};
 
+	// settings in use, and as last set (which are applied by reset(), as the filters must be re-derived)
 	int osIdx = 0;
+	OversamplingFilterType filterType = BUTTERWORTH_FILTER;
+	int nextOsIdx = 0;
+	OversamplingFilterType nextFilterType = BUTTERWORTH_FILTER;
+	float sampleRate = 48000.f;
+
+	T osBuffer[MaxRatio * maxBlockSize];
+
+	// BUTTERWORTH_FILTER, see Oversampling
+	AAFilter<filtN, T> aaFilter; // anti-aliasing filter
+	AAFilter<filtN, T> aiFilter; // anti-imaging filter
 
-	Oversampling < 1 << 0, filtN > os0; // 1x
-	Oversampling < 1 << 1, filtN > os1; // 2x
-	Oversampling < 1 << 2, filtN > os2; // 4x
-	Oversampling < 1 << 3, filtN > os3; // 8x
-	Oversampling < 1 << 4, filtN > os4; // 16x
-	BaseOversampling* oss[NumOS] = { &os0, &os1, &os2, &os3, &os4 };
+	// HALFBAND_FILTER, see HalfbandOversampling
+	HalfbandFilter<8, T> upFirst, downFirst;
+	HalfbandFilter<4, T> upStages[MaxStages - 1], downStages[MaxStages - 1];
 };
 
 } // namespace chowdsp
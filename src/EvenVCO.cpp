@@ -2,6 +2,34 @@
 
 using simd::float_4;
 
+// Band-limited step generator for 4 voices at once, using polyBLEP (a two sample polynomial approximation of the
+// band-limited step residual). Unlike dsp::MinBlepGenerator, the correction starts one sample before the discontinuity,
+// so process() returns the corrected signal delayed by one sample.
+struct PolyBlepGenerator_4 {
+
+	/** Inserts a discontinuity of size jump, at p samples relative to the current sample (-1 < p <= 0), in the voices set in mask */
+	void insertDiscontinuity(float_4 mask, float_4 p, float_4 jump) {
+		mask = mask & (p > -1.f) & (p <= 0.f);
+		const float_4 after = 1.f + p;
+		correctionPrevious += ifelse(mask, 0.5f * jump * p * p, 0.f);
+		correctionCurrent -= ifelse(mask, 0.5f * jump * after * after, 0.f);
+	}
+
+	/** Takes the naive signal for the current sample, and returns the corrected signal for the previous sample */
+	float_4 process(float_4 x) {
+		const float_4 y = previous + correctionPrevious;
+		previous = x;
+		correctionPrevious = correctionCurrent;
+		correctionCurrent = 0.f;
+		return y;
+	}
+
+private:
+	float_4 previous = 0.f;
+	float_4 correctionPrevious = 0.f;
+	float_4 correctionCurrent = 0.f;
+};
+
 struct EvenVCO : Module {
 	enum ParamIds {
 		OCTAVE_PARAM,
@@ -32,15 +60,14 @@ struct EvenVCO : Module {
 	/** The value of the last sync input */
 	float sync = 0.0;
 	/** The outputs */
-	/** Whether we are past the pulse width already */
-	bool halfPhase[PORT_MAX_CHANNELS] = {};
+	/** Whether we are past the pulse width already (mask) */
+	float_4 halfPhase[4] = {};
 
-	dsp::MinBlepGenerator<16, 32> triSquareMinBlep[PORT_MAX_CHANNELS];
-	dsp::MinBlepGenerator<16, 32> triMinBlep[PORT_MAX_CHANNELS];
-	dsp::MinBlepGenerator<16, 32> sineMinBlep[PORT_MAX_CHANNELS];
-	dsp::MinBlepGenerator<16, 32> doubleSawMinBlep[PORT_MAX_CHANNELS];
-	dsp::MinBlepGenerator<16, 32> sawMinBlep[PORT_MAX_CHANNELS];
-	dsp::MinBlepGenerator<16, 32> squareMinBlep[PORT_MAX_CHANNELS];
+	// band-limiting of the discontinuous waveforms, 4 voices per generator
+	PolyBlepGenerator_4 triSquareBlep[4];
+	PolyBlepGenerator_4 doubleSawBlep[4];
+	PolyBlepGenerator_4 sawBlep[4];
+	PolyBlepGenerator_4 squareBlep[4];
 
 	EvenVCO() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS);
@@ -120,40 +147,6 @@ struct EvenVCO : Module {
 			phase[c / 4] += deltaPhase[c / 4];
 		}
 
-		// the next block can't be done with SIMD instructions, but should at least be completed with
-		// blocks of 4 (otherwise popping artfifacts are generated from invalid phase/oldPhase/deltaPhase)
-		const int channelsRoundedUpNearestFour = (1 + (channels - 1) / 4) * 4;
-		for (int c = 0; c < channelsRoundedUpNearestFour; c++) {
-
-			if (oldPhase[c / 4].s[c % 4] < 0.5 && phase[c / 4].s[c % 4] >= 0.5) {
-				float crossing = -(phase[c / 4].s[c % 4] - 0.5) / deltaPhase[c / 4].s[c % 4];
-				triSquareMinBlep[c].insertDiscontinuity(crossing, 2.f);
-				doubleSawMinBlep[c].insertDiscontinuity(crossing, -2.f);
-			}
-
-			if (!halfPhase[c] && phase[c / 4].s[c % 4] >= pw[c / 4].s[c % 4]) {
-				float crossing  = -(phase[c / 4].s[c % 4] - pw[c / 4].s[c % 4]) / deltaPhase[c / 4].s[c % 4];
-				squareMinBlep[c].insertDiscontinuity(crossing, 2.f);
-				halfPhase[c] = true;
-			}
-
-			// Reset phase if at end of cycle
-			if (phase[c / 4].s[c % 4] >= 1.f) {
-				phase[c / 4].s[c % 4] -= 1.f;
-				float crossing = -phase[c / 4].s[c % 4] / deltaPhase[c / 4].s[c % 4];
-				triSquareMinBlep[c].insertDiscontinuity(crossing, -2.f);
-				doubleSawMinBlep[c].insertDiscontinuity(crossing, -2.f);
-				squareMinBlep[c].insertDiscontinuity(crossing, -2.f);
-				sawMinBlep[c].insertDiscontinuity(crossing, -2.f);
-				halfPhase[c] = false;
-			}
-		}
-
-		float_4 triSquareMinBlepOut[4] = {};
-		float_4 doubleSawMinBlepOut[4] = {};
-		float_4 sawMinBlepOut[4] = {};
-		float_4 squareMinBlepOut[4] = {};
-
 		float_4 triSquare[4] = {};
 		float_4 sine[4] = {};
 		float_4 doubleSaw[4] = {};
@@ -163,17 +156,33 @@ struct EvenVCO : Module {
 		float_4 square[4] = {};
 		float_4 triOut[4] = {};
 
-		for (int c = 0; c < channelsRoundedUpNearestFour; c++) {
-			triSquareMinBlepOut[c / 4].s[c % 4] = triSquareMinBlep[c].process();
-			doubleSawMinBlepOut[c / 4].s[c % 4] = doubleSawMinBlep[c].process();
-			sawMinBlepOut[c / 4].s[c % 4] = sawMinBlep[c].process();
-			squareMinBlepOut[c / 4].s[c % 4] = squareMinBlep[c].process();
-		}
-
 		for (int c = 0; c < channels; c += 4) {
 
-			triSquare[c / 4] = simd::ifelse((phase[c / 4] < 0.5f), -1.f, +1.f);
-			triSquare[c / 4] += triSquareMinBlepOut[c / 4];
+			// insert discontinuities at the half cycle
+			const float_4 halfCycle = (oldPhase[c / 4] < 0.5f) & (phase[c / 4] >= 0.5f);
+			float_4 crossing = -(phase[c / 4] - 0.5f) / deltaPhase[c / 4];
+			triSquareBlep[c / 4].insertDiscontinuity(halfCycle, crossing, 2.f);
+			doubleSawBlep[c / 4].insertDiscontinuity(halfCycle, crossing, -2.f);
+
+			// ...at the pulse width
+			const float_4 pulseWidthCrossed = simd::andnot(halfPhase[c / 4], phase[c / 4] >= pw[c / 4]);
+			crossing = -(phase[c / 4] - pw[c / 4]) / deltaPhase[c / 4];
+			squareBlep[c / 4].insertDiscontinuity(pulseWidthCrossed, crossing, 2.f);
+			halfPhase[c / 4] = halfPhase[c / 4] | pulseWidthCrossed;
+
+			// ...and reset phase if at end of cycle
+			const float_4 endOfCycle = phase[c / 4] >= 1.f;
+			phase[c / 4] = ifelse(endOfCycle, phase[c / 4] - 1.f, phase[c / 4]);
+			crossing = -phase[c / 4] / deltaPhase[c / 4];
+			triSquareBlep[c / 4].insertDiscontinuity(endOfCycle, crossing, -2.f);
+			doubleSawBlep[c / 4].insertDiscontinuity(endOfCycle, crossing, -2.f);
+			squareBlep[c / 4].insertDiscontinuity(endOfCycle, crossing, -2.f);
+			sawBlep[c / 4].insertDiscontinuity(endOfCycle, crossing, -2.f);
+			halfPhase[c / 4] = simd::andnot(endOfCycle, halfPhase[c / 4]);
+
+			// the band-limited waveforms are delayed by a sample, so all outputs are generated from the previous phase
+
+			triSquare[c / 4] = triSquareBlep[c / 4].process(simd::ifelse((phase[c / 4] < 0.5f), -1.f, +1.f));
 
 			// Integrate square for triangle
 
@@ -181,19 +190,19 @@ struct EvenVCO : Module {
 			tri[c / 4] *= (1.f - 40.f * args.sampleTime);
 			triOut[c / 4] = 5.f * tri[c / 4];
 
-			sine[c / 4] = 5.f * simd::cos(2 * M_PI * phase[c / 4]);
+			sine[c / 4] = 5.f * simd::cos(2 * M_PI * oldPhase[c / 4]);
 
 			doubleSaw[c / 4] = simd::ifelse((phase[c / 4] < 0.5), (-1.f + 4.f * phase[c / 4]), (-1.f + 4.f * (phase[c / 4] - 0.5f)));
-			doubleSaw[c / 4] += doubleSawMinBlepOut[c / 4];
+			doubleSaw[c / 4] = doubleSawBlep[c / 4].process(doubleSaw[c / 4]);
 			doubleSaw[c / 4] *= 5.f;
 
 			even[c / 4] = 0.55 * (doubleSaw[c / 4] + 1.27 * sine[c / 4]);
 			saw[c / 4] = -1.f + 2.f * phase[c / 4];
-			saw[c / 4] += sawMinBlepOut[c / 4];
+			saw[c / 4] = sawBlep[c / 4].process(saw[c / 4]);
 			saw[c / 4] *= 5.f;
 
 			square[c / 4] = simd::ifelse((phase[c / 4] < pw[c / 4]),  -1.f, +1.f);
-			square[c / 4] += squareMinBlepOut[c / 4];
+			square[c / 4] = squareBlep[c / 4].process(square[c / 4]);
 			square[c / 4] *= 5.f;
 
 			// Set outputs
@@ -116,6 +116,41 @@ private:
 };
 
 
+// Lock-free channel for passing a small POD snapshot from one writer (e.g. DSP thread) to one
+// reader (e.g. GUI thread). This is a seqlock over two slots: the generation is odd while the writer
+// is filling the slot not currently published, and even once that slot is published (snapshot n lives
+// in slots[n & 1], where n = generation / 2). The reader copies the latest published slot, and retries
+// in the rare case that the writer has since started overwriting that same slot (two updates later).
+template <typename T>
+struct SnapshotDoubleBuffer {
+
+	void publish(const T& value) {
+		const uint32_t current = generation.load(std::memory_order_relaxed);
+		// mark the write as in progress before touching the slot
+		generation.store(current + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slots[((current >> 1) + 1) & 1] = value;
+		generation.store(current + 2, std::memory_order_release);
+	}
+
+	T read() const {
+		while (true) {
+			// round down to the last published (even) generation
+			const uint32_t published = generation.load(std::memory_order_acquire) & ~1u;
+			const T value = slots[(published >> 1) & 1];
+			std::atomic_thread_fence(std::memory_order_acquire);
+			// the slot we copied is only rewritten once the writer starts the next-but-one update
+			if (generation.load(std::memory_order_relaxed) - published <= 2) {
+				return value;
+			}
+		}
+	}
+
+private:
+	T slots[2] = {};
+	std::atomic<uint32_t> generation{0};
+};
+
 struct NoisePlethora : Module {
 	enum ParamIds {
 		// A params
@@ -181,6 +216,15 @@ struct NoisePlethora : Module {
 		BANK_MODE
 	};
 	ProgramKnobMode programKnobMode = PROGRAM_MODE;
+
+	// everything NoisePlethoraLEDDisplay needs, (bank/program are after program CV is applied)
+	struct DisplayState {
+		int8_t bank[2];
+		int8_t program[2];
+		int8_t activeSection;
+		int8_t knobMode;
+	};
+	SnapshotDoubleBuffer<DisplayState> displayState;
 	// one full turn of the program knob corresponds to an increment of dialResolution to the bank/program
 	static constexpr int dialResolution = 8;
 	// variable to store what the program knob was prior to the start of dragging (used to calculate deltas)
@@ -188,8 +232,18 @@ struct NoisePlethora : Module {
 
 	// section A/B
 	bool bypassFilters = false;
-	std::shared_ptr<NoisePlethoraPlugin> algorithm[2]; 		// pointer to actual algorithm
-	std::string algorithmName[2];							// variable to cache which algorithm is active (after program CV applied)
+	AlgorithmPool algorithmPool[2];						// every algorithm, pre-constructed for each section
+	NoisePlethoraPlugin* algorithm[2] = {}; 			// pointer to actual algorithm (owned by algorithmPool)
+	int algorithmId[2] = {-1, -1};						// variable to cache which algorithm is active (after program CV applied)
+	// optionally, A/B can be rendered at the Teensy's sample rate and resampled to the engine rate (constant CPU
+	// regardless of engine sample rate, and closer to the hardware)
+	bool renderAtTeensyRate = false;
+	bool renderingAtTeensyRate = false; 				// the mode algorithms were last initialised in
+	dsp::SampleRateConverter<1> teensyRateConverter[2];
+	dsp::DoubleRingBuffer<dsp::Frame<1>, 4096> teensyRateOutput[2];	// enough for one block at 768kHz
+	// optionally, A/B can use float kernels for the Teensy audio objects, which are not bit-exact with the hardware. Each
+	// object converts its int16 blocks to float and back, so only the filter and mixer are faster than fixed-point.
+	bool floatEngine = false;
 
 	// filters for A/B
 	StateVariableFilter2ndOrder svfFilter[2];
@@ -199,8 +253,6 @@ struct NoisePlethora : Module {
 	ProgramSelector programSelector; 		// tracks banks and programs for both sections A/B, including which is the "active" section
 	ProgramSelector programSelectorWithCV; 	// as above, but also with CV for program applied as an offset - works like Plaits Model CV input
 	// UI / UX for A/B
-	std::string textDisplayA = " ", textDisplayB = " ";
-	bool isDisplayActiveA = false, isDisplayActiveB = false;
 	bool programButtonHeld = false;
 	bool programButtonDragged = false;
 	dsp::BooleanTrigger programHoldTrigger;
@@ -259,14 +311,14 @@ struct NoisePlethora : Module {
 		getInputInfo(PROG_A_INPUT)->description = "CV sums with active program (0.5V increments)";
 		getInputInfo(PROG_B_INPUT)->description = "CV sums with active program (0.5V increments)";
 
-		setAlgorithm(SECTION_B, "radioOhNo");
-		setAlgorithm(SECTION_A, "radioOhNo");
+		setAlgorithm(SECTION_B, findAlgorithmId("radioOhNo"));
+		setAlgorithm(SECTION_A, findAlgorithmId("radioOhNo"));
 		onSampleRateChange();
 	}
 
 	void onReset(const ResetEvent& e) override {
-		setAlgorithm(SECTION_B, "radioOhNo");
-		setAlgorithm(SECTION_A, "radioOhNo");
+		setAlgorithm(SECTION_B, findAlgorithmId("radioOhNo"));
+		setAlgorithm(SECTION_A, findAlgorithmId("radioOhNo"));
 		Module::onReset(e);
 	}
 
@@ -278,16 +330,42 @@ struct NoisePlethora : Module {
 		blockDCFilter[SECTION_B].setFrequency(fc);
 		blockDCFilter[SECTION_C].setFrequency(fc);
 
-		if (algorithm[SECTION_A]) {
-			algorithm[SECTION_A]->init();
+		for (int i = 0; i < 2; i++) {
+			teensyRateConverter[i].setRates(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate());
 		}
-		if (algorithm[SECTION_B]) {
-			algorithm[SECTION_B]->init();
+
+		initialiseAlgorithms();
+	}
+
+	// (re)initialise algorithms A and B at the rate they are rendered at
+	void initialiseAlgorithms() {
+		teensy::RenderSampleRateScope renderSampleRate(getRenderSampleRate());
+
+		for (int i = 0; i < 2; i++) {
+			if (algorithm[i]) {
+				algorithm[i]->init();
+			}
 		}
 	}
 
+	// sample rate algorithms A and B are rendered at (0 means engine sample rate)
+	float getRenderSampleRate() const {
+		return renderingAtTeensyRate ? AUDIO_SAMPLE_RATE_EXACT : 0.f;
+	}
+
 	void process(const ProcessArgs& args) override {
 
+		// render mode has changed (e.g. from context menu), so algorithms need to be initialised for the new rate
+		if (renderAtTeensyRate != renderingAtTeensyRate) {
+			renderingAtTeensyRate = renderAtTeensyRate;
+			for (int i = 0; i < 2; i++) {
+				resetTeensyRateResampler(i);
+			}
+			initialiseAlgorithms();
+		}
+		teensy::RenderSampleRateScope renderSampleRate(getRenderSampleRate());
+		teensy::FloatEngineScope floatEngineScope(floatEngine);
+
 		// we only periodically update parameters of each algorithm (once per block, ~2.9ms at 44100Hz)
 		bool updateParams = false;
 		if (!updateParamsTimer.process(args.sampleTime)) {
@@ -304,9 +382,11 @@ struct NoisePlethora : Module {
 		                  PROG_B_INPUT, X_B_INPUT, Y_B_INPUT, CUTOFF_B_INPUT, B_OUTPUT, args, updateParams);
 		processBottomSection(args);
 
-		// UI
-		updateDataForLEDDisplay();
-		processProgramBankKnobLogic(args);
+		// UI, only needs to run at the same (control) rate as parameter updates
+		if (updateParams) {
+			processProgramBankKnobLogic(updateTimeSecs);
+			updateDataForLEDDisplay();
+		}
 	}
 
 	// process CV for section, specifically: work out the offset relative to the current
@@ -326,20 +406,23 @@ struct NoisePlethora : Module {
 		programSelectorWithCV.getSection(SECTION).setBank(bank);
 		programSelectorWithCV.getSection(SECTION).setProgram(programWithCV);
 
-		const std::string newAlgorithmName = programSelectorWithCV.getSection(SECTION).getCurrentProgramName();
+		const int newAlgorithmId = programSelectorWithCV.getSection(SECTION).getCurrentProgramId();
 
 		// this is just a caching check to avoid constantly re-initialisating the algorithms
-		if (newAlgorithmName != algorithmName[SECTION]) {
+		if (newAlgorithmId != algorithmId[SECTION]) {
 
-			algorithm[SECTION] = MyFactory::Instance()->Create(newAlgorithmName);
-			algorithmName[SECTION] = newAlgorithmName;
+			algorithm[SECTION] = algorithmPool[SECTION].get(newAlgorithmId);
+			algorithmId[SECTION] = newAlgorithmId;
 
 			if (algorithm[SECTION]) {
+				algorithm[SECTION]->resetGraph();
 				algorithm[SECTION]->init();
 			}
 			else {
-				DEBUG("WARNING: Failed to initialise %s in programSelector", newAlgorithmName.c_str());
+				DEBUG("WARNING: Failed to initialise algorithm %d in programSelector", newAlgorithmId);
 			}
+			// drop any audio (and resampler history) left over from the previous algorithm
+			resetTeensyRateResampler(SECTION);
 		}
 	}
 
@@ -364,7 +447,7 @@ struct NoisePlethora : Module {
 				algorithm[SECTION]->process(clamp(cvX, 0.f, 1.f), clamp(cvY, 0.f, 1.f));
 			}
 			// process the audio graph
-			out = algorithm[SECTION]->processGraph();
+			out = renderingAtTeensyRate ? processGraphAtTeensyRate(SECTION) : algorithm[SECTION]->processGraph();
 			// each algorithm has a specific gain factor
 			out = out * programSelectorWithCV.getSection(SECTION).getCurrentProgramGain();
 
@@ -395,6 +478,33 @@ struct NoisePlethora : Module {
 		outputs[OUTPUT].setVoltage(Saturator::process(out) * 5.f);
 	}
 
+	// algorithm output for the current (engine rate) sample, when the algorithm is rendered at the Teensy rate
+	float processGraphAtTeensyRate(Section SECTION) {
+		// render a block at the Teensy rate, and convert to engine rate (the resampler may
+		// not produce any output for the first block or so, hence the loop)
+		while (teensyRateOutput[SECTION].empty()) {
+			dsp::Frame<1> teensyRateBlock[AUDIO_BLOCK_SAMPLES];
+			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				teensyRateBlock[i].samples[0] = algorithm[SECTION]->processGraph();
+			}
+
+			int inLen = AUDIO_BLOCK_SAMPLES;
+			int outLen = teensyRateOutput[SECTION].capacity();
+			teensyRateConverter[SECTION].process(teensyRateBlock, &inLen, teensyRateOutput[SECTION].endData(), &outLen);
+			teensyRateOutput[SECTION].endIncr(outLen);
+		}
+
+		return teensyRateOutput[SECTION].shift().samples[0];
+	}
+
+	// clears buffered output and filter history of the Teensy rate resampler, without reallocating it
+	void resetTeensyRateResampler(int section) {
+		teensyRateOutput[section].clear();
+		if (teensyRateConverter[section].st) {
+			speex_resampler_reset_mem(teensyRateConverter[section].st);
+		}
+	}
+
 	// process section C
 	void processBottomSection(const ProcessArgs& args) {
 
@@ -437,28 +547,21 @@ struct NoisePlethora : Module {
 		outputs[FILTERED_OUTPUT].setVoltage(out * 5.f);
 	}
 
-	// set which text NoisePlethoraWidget should display on the 7 segment display
+	// publish what NoisePlethoraWidget should display on the 7 segment displays (text is formatted on the GUI thread)
 	void updateDataForLEDDisplay() {
+		DisplayState state;
+		state.bank[SECTION_A] = programSelectorWithCV.getA().getBank();
+		state.program[SECTION_A] = programSelectorWithCV.getA().getProgram();
+		state.bank[SECTION_B] = programSelectorWithCV.getB().getBank();
+		state.program[SECTION_B] = programSelectorWithCV.getB().getProgram();
+		state.activeSection = programSelectorWithCV.getMode();
+		state.knobMode = programKnobMode;
 
-		if (programKnobMode == PROGRAM_MODE) {
-			textDisplayA = std::to_string(programSelectorWithCV.getA().getProgram());
-		}
-		else if (programKnobMode == BANK_MODE) {
-			textDisplayA = 'A' + programSelectorWithCV.getA().getBank();
-		}
-		isDisplayActiveA = programSelectorWithCV.getMode() == SECTION_A;
-
-		if (programKnobMode == PROGRAM_MODE) {
-			textDisplayB = std::to_string(programSelectorWithCV.getB().getProgram());
-		}
-		else if (programKnobMode == BANK_MODE) {
-			textDisplayB = 'A' + programSelectorWithCV.getB().getBank();
-		}
-		isDisplayActiveB = programSelectorWithCV.getMode() == SECTION_B;
+		displayState.publish(state);
 	}
 
-	// handle convoluted logic for the multifunction Program knob
-	void processProgramBankKnobLogic(const ProcessArgs& args) {
+	// handle convoluted logic for the multifunction Program knob, deltaTime is time since last call
+	void processProgramBankKnobLogic(float deltaTime) {
 
 		// program knob will either change program for current bank...
 		if (programButtonDragged) {
@@ -497,7 +600,7 @@ struct NoisePlethora : Module {
 		}
 		else {
 			if (programButtonHeld) {
-				programHoldTimer.process(args.sampleTime);
+				programHoldTimer.process(deltaTime);
 
 				// if we've held for at least 0.5 seconds, switch into "bank mode"
 				if (programHoldTimer.time > 0.5f) {
@@ -530,10 +633,9 @@ struct NoisePlethora : Module {
 	void setAlgorithmViaProgram(int newProgram) {
 
 		const int currentBank = programSelector.getCurrent().getBank();
-		const std::string algorithmName = getBankForIndex(currentBank).getProgramName(newProgram);
 		const int section = programSelector.getMode();
 
-		setAlgorithm(section, algorithmName);
+		setAlgorithm(section, getAlgorithmId(currentBank, newProgram));
 	}
 
 	void setAlgorithmViaBank(int newBank) {
@@ -541,42 +643,38 @@ struct NoisePlethora : Module {
 		const int currentProgram = programSelector.getCurrent().getProgram();
 		// the new bank may not have as many algorithms
 		const int currentProgramInNewBank = clamp(currentProgram, 0, getBankForIndex(newBank).getSize() - 1);
-		const std::string algorithmName = getBankForIndex(newBank).getProgramName(currentProgramInNewBank);
 		const int section = programSelector.getMode();
 
-		setAlgorithm(section, algorithmName);
+		setAlgorithm(section, getAlgorithmId(newBank, currentProgramInNewBank));
 	}
 
-	void setAlgorithm(int section, std::string algorithmName) {
+	void setAlgorithm(int section, int newAlgorithmId) {
 
 		if (section > 1) {
 			return;
 		}
 
-		for (int bank = 0; bank < numBanks; ++bank) {
-			for (int program = 0; program < getBankForIndex(bank).getSize(); ++program) {
-				if (getBankForIndex(bank).getProgramName(program) == algorithmName) {
-					programSelector.setMode(section);
-					programSelector.getCurrent().setBank(bank);
-					programSelector.getCurrent().setProgram(program);
-
-					return;
-				}
-			}
+		const int bank = newAlgorithmId / programsPerBank;
+		const int program = newAlgorithmId % programsPerBank;
+		if (newAlgorithmId < 0 || bank >= numBanks || program >= getBankForIndex(bank).getSize()) {
+			DEBUG("WARNING: Didn't find algorithm %d in programSelector", newAlgorithmId);
+			return;
 		}
 
-		DEBUG("WARNING: Didn't find %s in programSelector", algorithmName.c_str());
+		programSelector.setMode(section);
+		programSelector.getCurrent().setBank(bank);
+		programSelector.getCurrent().setProgram(program);
 	}
 
 	void dataFromJson(json_t* rootJ) override {
 		json_t* bankAJ = json_object_get(rootJ, "algorithmA");
 		if (bankAJ) {
-			setAlgorithm(SECTION_A, json_string_value(bankAJ));
+			setAlgorithm(SECTION_A, findAlgorithmId(json_string_value(bankAJ)));
 		}
 
 		json_t* bankBJ = json_object_get(rootJ, "algorithmB");
 		if (bankBJ) {
-			setAlgorithm(SECTION_B, json_string_value(bankBJ));
+			setAlgorithm(SECTION_B, findAlgorithmId(json_string_value(bankBJ)));
 		}
 
 		json_t* bypassFiltersJ = json_object_get(rootJ, "bypassFilters");
@@ -588,16 +686,28 @@ struct NoisePlethora : Module {
 		if (blockDCJ) {
 			blockDC = json_boolean_value(blockDCJ);
 		}
+
+		json_t* renderAtTeensyRateJ = json_object_get(rootJ, "renderAtTeensyRate");
+		if (renderAtTeensyRateJ) {
+			renderAtTeensyRate = json_boolean_value(renderAtTeensyRateJ);
+		}
+
+		json_t* floatEngineJ = json_object_get(rootJ, "floatEngine");
+		if (floatEngineJ) {
+			floatEngine = json_boolean_value(floatEngineJ);
+		}
 	}
 
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 
-		json_object_set_new(rootJ, "algorithmA", json_string(programSelector.getA().getCurrentProgramName().c_str()));
-		json_object_set_new(rootJ, "algorithmB", json_string(programSelector.getB().getCurrentProgramName().c_str()));
+		json_object_set_new(rootJ, "algorithmA", json_string(programSelector.getA().getCurrentProgramName()));
+		json_object_set_new(rootJ, "algorithmB", json_string(programSelector.getB().getCurrentProgramName()));
 
 		json_object_set_new(rootJ, "bypassFilters", json_boolean(bypassFilters));
 		json_object_set_new(rootJ, "blockDC", json_boolean(blockDC));
+		json_object_set_new(rootJ, "renderAtTeensyRate", json_boolean(renderAtTeensyRate));
+		json_object_set_new(rootJ, "floatEngine", json_boolean(floatEngine));
 
 		return rootJ;
 	}
@@ -741,7 +851,13 @@ struct NoisePlethoraLEDDisplay : LightWidget {
 
 			std::string text = "A";  // fallback if module not yet defined
 			if (module) {
-				text = (section == NoisePlethora::SECTION_A) ? module->textDisplayA : module->textDisplayB;
+				const NoisePlethora::DisplayState state = module->displayState.read();
+				if (state.knobMode == NoisePlethora::PROGRAM_MODE) {
+					text = std::to_string(state.program[section]);
+				}
+				else {
+					text = 'A' + state.bank[section];
+				}
 			}
 			char buffer[numChars + 1];
 			int l = text.size();
@@ -768,7 +884,7 @@ struct NoisePlethoraLEDDisplay : LightWidget {
 		}
 
 		if (module) {
-			const bool isSectionDisplayActive = (section == NoisePlethora::SECTION_A) ? module->isDisplayActiveA : module->isDisplayActiveB;
+			const bool isSectionDisplayActive = module->displayState.read().activeSection == section;
 
 			// active bank dot
 			nvgBeginPath(args.vg);
@@ -869,24 +985,10 @@ struct NoisePlethoraWidget : ModuleWidget {
 							const bool currentProgramAndBank = (currentProgram == j) && (currentBank == i);
 							const std::string algorithmName = getBankForIndex(i).getProgramName(j);
 
-							bool implemented = false;
-							for (auto item : MyFactory::Instance()->factoryFunctionRegistry) {
-								if (item.first == algorithmName) {
-									implemented = true;
-									break;
-								}
-							}
-
-							if (implemented) {
-								menu->addChild(createMenuItem(algorithmName, currentProgramAndBank ? CHECKMARK_STRING : "",
-								[ = ]() {
-									module->setAlgorithm(sectionId, algorithmName);
-								}));
-							}
-							else {
-								// placeholder text (greyed out)
-								menu->addChild(createMenuLabel(algorithmName));
-							}
+							menu->addChild(createMenuItem(algorithmName, currentProgramAndBank ? CHECKMARK_STRING : "",
+							[ = ]() {
+								module->setAlgorithm(sectionId, getAlgorithmId(i, j));
+							}));
 						}
 					}));
 				}
@@ -894,6 +996,8 @@ struct NoisePlethoraWidget : ModuleWidget {
 
 
 		}
+		menu->addChild(createBoolPtrMenuItem("Render at 44.1kHz (Teensy rate)", "", &module->renderAtTeensyRate));
+		menu->addChild(createBoolPtrMenuItem("Float engine (not bit-exact)", "", &module->floatEngine));
 
 		menu->addChild(createMenuLabel("Filters"));
 		menu->addChild(createBoolPtrMenuItem("Remove DC", "", &module->blockDC));
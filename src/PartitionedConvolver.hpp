@@ -0,0 +1,410 @@
+#pragma once
+#include <rack.hpp>
+#include <pffft.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+
+/** The FFTs of a kernel, split into partitions of `blockSize` samples (each zero padded to `blockSize * 2`).
+Immutable once constructed, so that a single instance can be shared (read-only) by any number of convolvers.
+*/
+struct KernelSpectrum {
+	// `numPartitions` contiguous FFT blocks of size `blockSize * 2`, indexed by [i * blockSize * 2 + j]
+	float* ffts = NULL;
+	const size_t blockSize;
+	const size_t numPartitions;
+
+	/** Computes the spectrum of kernel[0:length), which must not be empty. */
+	KernelSpectrum(const float* kernel, size_t length, size_t blockSize) :
+		blockSize(blockSize),
+		numPartitions((length - 1) / blockSize + 1) {
+		PFFFT_Setup* pffft = pffft_new_setup(blockSize * 2, PFFFT_REAL);
+		float* tmpBlock = (float*) pffft_aligned_malloc(sizeof(float) * blockSize * 2);
+		ffts = (float*) pffft_aligned_malloc(sizeof(float) * blockSize * 2 * numPartitions);
+
+		for (size_t i = 0; i < numPartitions; i++) {
+			// Pad each block with zeros
+			std::memset(tmpBlock, 0, sizeof(float) * blockSize * 2);
+			size_t len = std::min(blockSize, length - i * blockSize);
+			std::memcpy(tmpBlock, &kernel[i * blockSize], sizeof(float) * len);
+			// Compute fft
+			pffft_transform(pffft, tmpBlock, &ffts[blockSize * 2 * i], NULL, PFFFT_FORWARD);
+		}
+
+		pffft_aligned_free(tmpBlock);
+		pffft_destroy_setup(pffft);
+	}
+
+	~KernelSpectrum() {
+		pffft_aligned_free(ffts);
+	}
+
+	KernelSpectrum(const KernelSpectrum&) = delete;
+	KernelSpectrum& operator=(const KernelSpectrum&) = delete;
+
+	const float* getPartition(size_t i) const {
+		return &ffts[blockSize * 2 * i];
+	}
+};
+
+
+/** Uniformly partitioned, frequency domain convolution of blocks of `blockSize` samples (overlap-add, with a
+frequency domain delay line), as per rack::dsp::RealTimeConvolver, but with the steps exposed so that the
+multiply-accumulate over kernel partitions can be split across several calls (see PartitionedConvolver).
+Only the input history and output accumulators belong to the convolver, the kernel spectrum is shared.
+
+Up to PORT_MAX_CHANNELS channels are convolved with the same kernel. Channel data is passed channel-major, i.e.
+sample i of channel c is at [c * blockSize + i]. The multiply-accumulate is batched across channels, so that each
+kernel partition is read from memory once per block, rather than once per channel. State is allocated up front for
+the channels reserved with reserveChannels() (one by default), so that changing the number of channels doesn't allocate.
+Channel state is only (re)allocated under `allocationMutex`, as setKernel() and reserveChannels() may be called from
+different threads (e.g. on a sample rate change, and from the UI).
+*/
+struct UniformPartitionedConvolver {
+	struct Channel {
+		// `numPartitions` contiguous FFT blocks of size `blockSize * 2`, indexed by [i * blockSize * 2 + j]
+		float* inputFfts = NULL;
+		float* outputFft = NULL;
+		float* outputTail = NULL;
+	};
+
+	std::shared_ptr<const KernelSpectrum> kernel;
+	Channel channelStates[PORT_MAX_CHANNELS];
+	float* tmpBlock = NULL;
+	size_t blockSize;
+	size_t numPartitions = 0;
+	size_t inputPos = 0;
+	int channels = 1;
+	// channels whose state is allocated
+	std::atomic<int> reservedChannels{0};
+	std::mutex allocationMutex;
+	PFFFT_Setup* pffft;
+
+	UniformPartitionedConvolver(size_t blockSize) : blockSize(blockSize) {
+		pffft = pffft_new_setup(blockSize * 2, PFFFT_REAL);
+		tmpBlock = allocateBlock(blockSize * 2);
+		reserveChannels(1);
+	}
+
+	~UniformPartitionedConvolver() {
+		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+			freeChannel(channelStates[c]);
+		}
+		pffft_aligned_free(tmpBlock);
+		pffft_destroy_setup(pffft);
+	}
+
+	void clearKernel() {
+		std::lock_guard<std::mutex> lock(allocationMutex);
+		freeDelayLines();
+	}
+
+	/** Sets the kernel, which must have been partitioned with the same block size. */
+	void setKernel(std::shared_ptr<const KernelSpectrum> kernel) {
+		assert(kernel->blockSize == blockSize);
+		std::lock_guard<std::mutex> lock(allocationMutex);
+		// the delay lines can be reused if they're the right length
+		if (kernel->numPartitions != numPartitions) {
+			freeDelayLines();
+			numPartitions = kernel->numPartitions;
+			for (int c = 0; c < reservedChannels; c++) {
+				allocateChannel(c);
+			}
+		}
+		this->kernel = kernel;
+		reset();
+	}
+
+	/** Allocates state for (at least) the given number of channels. This allocates, so should be called off the
+	audio thread, but may be called while another thread is processing the channels already reserved.
+	*/
+	void reserveChannels(int channels) {
+		channels = rack::math::clamp(channels, 1, PORT_MAX_CHANNELS);
+		std::lock_guard<std::mutex> lock(allocationMutex);
+		for (int c = reservedChannels; c < channels; c++) {
+			allocateChannel(c);
+		}
+		if (channels > reservedChannels) {
+			reservedChannels = channels;
+		}
+	}
+
+	/** Sets the number of channels to convolve, limited to those reserved. Doesn't allocate. */
+	void setChannels(int channels) {
+		channels = rack::math::clamp(channels, 1, (int) reservedChannels);
+		// channels that are (re)starting have no history
+		for (int c = this->channels; c < channels; c++) {
+			resetChannel(c);
+		}
+		this->channels = channels;
+	}
+
+	/** Clears the input history and any pending output. */
+	void reset() {
+		for (int c = 0; c < channels; c++) {
+			resetChannel(c);
+		}
+	}
+
+	/** Adds a block of `blockSize` samples per channel to the delay lines, and clears the output accumulators. */
+	void pushInput(const float* input) {
+		inputPos = (inputPos + 1) % numPartitions;
+		for (int c = 0; c < channels; c++) {
+			Channel& channel = channelStates[c];
+			std::memset(tmpBlock, 0, sizeof(float) * blockSize * 2);
+			std::memcpy(tmpBlock, &input[c * blockSize], sizeof(float) * blockSize);
+			pffft_transform(pffft, tmpBlock, &channel.inputFfts[blockSize * 2 * inputPos], NULL, PFFFT_FORWARD);
+			std::memset(channel.outputFft, 0, sizeof(float) * blockSize * 2);
+		}
+	}
+
+	/** Convolves the delay lines with kernel partitions [begin, end). */
+	void accumulate(size_t begin, size_t end) {
+		// Note: This is the CPU bottleneck loop
+		for (size_t i = begin; i < end; i++) {
+			const float* kernelFft = kernel->getPartition(i);
+			size_t pos = (inputPos + numPartitions - i) % numPartitions;
+			for (int c = 0; c < channels; c++) {
+				Channel& channel = channelStates[c];
+				pffft_zconvolve_accumulate(pffft, kernelFft, &channel.inputFfts[blockSize * 2 * pos], channel.outputFft, 1.f);
+			}
+		}
+	}
+
+	/** Writes the output blocks of `blockSize` samples per channel, once all partitions have been accumulated. */
+	void processOutput(float* output) {
+		const float scale = 1.f / (blockSize * 2);
+		for (int c = 0; c < channels; c++) {
+			Channel& channel = channelStates[c];
+			pffft_transform(pffft, channel.outputFft, tmpBlock, NULL, PFFFT_BACKWARD);
+			for (size_t i = 0; i < blockSize; i++) {
+				output[c * blockSize + i] = (tmpBlock[i] + channel.outputTail[i]) * scale;
+				channel.outputTail[i] = tmpBlock[blockSize + i];
+			}
+		}
+	}
+
+	void processBlock(const float* input, float* output) {
+		pushInput(input);
+		accumulate(0, numPartitions);
+		processOutput(output);
+	}
+
+private:
+	static float* allocateBlock(size_t length) {
+		float* block = (float*) pffft_aligned_malloc(sizeof(float) * length);
+		std::memset(block, 0, sizeof(float) * length);
+		return block;
+	}
+
+	// frees the kernel and the channels' delay lines, whose length depends on it
+	void freeDelayLines() {
+		kernel.reset();
+		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+			if (channelStates[c].inputFfts) {
+				pffft_aligned_free(channelStates[c].inputFfts);
+				channelStates[c].inputFfts = NULL;
+			}
+		}
+		numPartitions = 0;
+		inputPos = 0;
+	}
+
+	// allocates any of the channel's state not yet allocated
+	void allocateChannel(int c) {
+		Channel& channel = channelStates[c];
+		if (!channel.outputFft) {
+			channel.outputFft = allocateBlock(blockSize * 2);
+			channel.outputTail = allocateBlock(blockSize);
+		}
+		if (numPartitions > 0 && !channel.inputFfts) {
+			channel.inputFfts = allocateBlock(blockSize * 2 * numPartitions);
+		}
+	}
+
+	// clears the (allocated) channel's state
+	void resetChannel(int c) {
+		Channel& channel = channelStates[c];
+		std::memset(channel.outputFft, 0, sizeof(float) * blockSize * 2);
+		std::memset(channel.outputTail, 0, sizeof(float) * blockSize);
+		if (numPartitions > 0) {
+			std::memset(channel.inputFfts, 0, sizeof(float) * blockSize * 2 * numPartitions);
+		}
+	}
+
+	static void freeChannel(Channel& channel) {
+		if (channel.inputFfts) {
+			pffft_aligned_free(channel.inputFfts);
+		}
+		if (channel.outputFft) {
+			pffft_aligned_free(channel.outputFft);
+			pffft_aligned_free(channel.outputTail);
+		}
+		channel = Channel();
+	}
+};
+
+
+/** A kernel partitioned for PartitionedConvolver: the head, kernel[0:2 * tailBlockSize), in partitions of
+`headBlockSize` samples, and the rest of the kernel (if any) in partitions of `tailBlockSize` samples.
+*/
+struct PartitionedKernel {
+	std::shared_ptr<const KernelSpectrum> head;
+	std::shared_ptr<const KernelSpectrum> tail;
+	size_t length = 0;
+
+	static std::shared_ptr<const PartitionedKernel> create(const float* kernel, size_t length, size_t headBlockSize, size_t tailBlockSize) {
+		std::shared_ptr<PartitionedKernel> partitioned = std::make_shared<PartitionedKernel>();
+		partitioned->length = length;
+		const size_t headLength = 2 * tailBlockSize;
+		partitioned->head = std::make_shared<const KernelSpectrum>(kernel, std::min(length, headLength), headBlockSize);
+		if (length > headLength) {
+			partitioned->tail = std::make_shared<const KernelSpectrum>(kernel + headLength, length - headLength, tailBlockSize);
+		}
+		return partitioned;
+	}
+};
+
+
+/** Low latency convolution for long kernels, processing blocks of `headBlockSize` samples (per channel, laid out
+channel-major as for UniformPartitionedConvolver).
+
+The kernel is split in two (non-uniform partitioning, see Gardner, "Efficient Convolution without Input-Output
+Delay", and Wefers, "Partitioned convolution algorithms for real-time auralization"). The head, kernel[0:2 * tailBlockSize),
+is convolved with short partitions, so latency is a single head block. The rest of the kernel is convolved with long
+partitions, whose work is spread evenly over the head blocks: the tail FFT of a completed input block is computed
+during the first head block, the multiply-accumulates during the following ones, and the inverse FFT during the last,
+one tail block before the output is needed. CPU cost per head block is therefore roughly constant.
+*/
+struct PartitionedConvolver {
+	const size_t headBlockSize;
+	const size_t tailBlockSize;
+	// number of head blocks per tail block
+	const size_t tailSteps;
+
+	UniformPartitionedConvolver head;
+	UniformPartitionedConvolver tail;
+	bool hasTail = false;
+	size_t kernelLength = 0;
+	int channels = 1;
+
+	// tail input, filled a head block at a time, and the previous (complete) tail input block
+	std::vector<float> tailInput;
+	std::vector<float> tailInputComplete;
+	// tail output for the current tail block, and the one being computed
+	std::vector<float> tailOutput;
+	std::vector<float> tailOutputNext;
+	size_t tailStep = 0;
+
+	PartitionedConvolver(size_t headBlockSize = 64, size_t tailBlockSize = 1024) :
+		headBlockSize(headBlockSize),
+		tailBlockSize(tailBlockSize),
+		tailSteps(tailBlockSize / headBlockSize),
+		head(headBlockSize),
+		tail(tailBlockSize),
+		tailInput(PORT_MAX_CHANNELS * tailBlockSize),
+		tailInputComplete(PORT_MAX_CHANNELS * tailBlockSize),
+		tailOutput(PORT_MAX_CHANNELS * tailBlockSize),
+		tailOutputNext(PORT_MAX_CHANNELS * tailBlockSize) {
+		// need at least one step each for the forward FFT, multiply-accumulate and inverse FFT
+		assert(tailBlockSize % headBlockSize == 0 && tailSteps >= 3);
+	}
+
+	/** Sets a kernel partitioned with this convolver's block sizes, which may be shared with other convolvers. */
+	void setKernel(std::shared_ptr<const PartitionedKernel> kernel) {
+		head.setKernel(kernel->head);
+		kernelLength = kernel->length;
+		hasTail = (bool) kernel->tail;
+		if (hasTail) {
+			tail.setKernel(kernel->tail);
+		}
+		else {
+			tail.clearKernel();
+		}
+		reset();
+	}
+
+	void setKernel(const float* kernel, size_t length) {
+		setKernel(PartitionedKernel::create(kernel, length, headBlockSize, tailBlockSize));
+	}
+
+	/** Allocates state for (at least) the given number of channels, see UniformPartitionedConvolver::reserveChannels(). */
+	void reserveChannels(int channels) {
+		head.reserveChannels(channels);
+		tail.reserveChannels(channels);
+	}
+
+	/** Sets the number of channels to convolve, limited to those reserved. Doesn't allocate. */
+	void setChannels(int channels) {
+		channels = rack::math::clamp(channels, 1, std::min<int>(head.reservedChannels, tail.reservedChannels));
+		if (channels == this->channels) {
+			return;
+		}
+		head.setChannels(channels);
+		tail.setChannels(channels);
+		// channels that are (re)starting have no pending tail
+		for (int c = this->channels; c < channels; c++) {
+			clearTailChannel(c);
+		}
+		this->channels = channels;
+	}
+
+	/** Latency in samples, when input is buffered into blocks. */
+	size_t getLatency() const {
+		return headBlockSize;
+	}
+
+	void reset() {
+		head.reset();
+		tail.reset();
+		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+			clearTailChannel(c);
+		}
+		tailStep = 0;
+	}
+
+	/** Convolves a block of `headBlockSize` samples per channel. */
+	void processBlock(const float* input, float* output) {
+		head.processBlock(input, output);
+
+		if (!hasTail) {
+			return;
+		}
+
+		const size_t offset = tailStep * headBlockSize;
+		for (int c = 0; c < channels; c++) {
+			std::memcpy(&tailInput[c * tailBlockSize + offset], &input[c * headBlockSize], sizeof(float) * headBlockSize);
+			for (size_t i = 0; i < headBlockSize; i++) {
+				output[c * headBlockSize + i] += tailOutput[c * tailBlockSize + offset + i];
+			}
+		}
+
+		// the tail convolution of the previous input block, a slice at a time
+		if (tailStep == 0) {
+			tail.pushInput(tailInputComplete.data());
+		}
+		else if (tailStep == tailSteps - 1) {
+			tail.processOutput(tailOutputNext.data());
+		}
+		else {
+			const size_t macSteps = tailSteps - 2;
+			const size_t step = tailStep - 1;
+			tail.accumulate(tail.numPartitions * step / macSteps, tail.numPartitions * (step + 1) / macSteps);
+		}
+
+		if (++tailStep == tailSteps) {
+			tailStep = 0;
+			std::swap(tailInput, tailInputComplete);
+			std::swap(tailOutput, tailOutputNext);
+		}
+	}
+
+private:
+	void clearTailChannel(int c) {
+		std::vector<float>* buffers[] = {&tailInput, &tailInputComplete, &tailOutput, &tailOutputNext};
+		for (std::vector<float>* buffer : buffers) {
+			std::fill(buffer->begin() + c * tailBlockSize, buffer->begin() + (c + 1) * tailBlockSize, 0.f);
+		}
+	}
+};
@@ -1,10 +1,434 @@
 #include "plugin.hpp"
-#include <pffft.h>
+#include "PartitionedConvolver.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#if defined ARCH_X64
+#include <pmmintrin.h>
+#endif
 
 BINARY(src_SpringReverbIR_pcm);
 
+using simd::float_4;
+
+
+// convolution block size, which is also the latency of the reverb
+static const size_t BLOCK_SIZE = 64;
+// block size for the tail of the impulse response, see PartitionedConvolver
+static const size_t TAIL_BLOCK_SIZE = 1024;
+// block size when convolving on the worker thread, latency is then two blocks
+static const size_t WORKER_BLOCK_SIZE = 1024;
+// how often the worker thread checks for input when it has none, well within a block (~21ms at 48kHz)
+static const std::chrono::microseconds WORKER_POLL_INTERVAL(500);
+// input (after the dry HPF) and output levels below which the reverb is considered silent, in volts
+static const float SILENCE_THRESHOLD = 1e-5f;
+// sample rate of the impulse response in SpringReverbIR.pcm
+static const float KERNEL_SAMPLE_RATE = 48000.f;
+
+
+// band-limited (windowed sinc) resampling of a kernel, scaled so that the gain of the convolution is unchanged
+static std::vector<float> resampleKernel(const float* kernel, size_t length, float fromRate, float toRate) {
+	// zero crossings of the sinc either side of the centre
+	const int halfTaps = 16;
+	const double ratio = fromRate / toRate;
+	// cutoff relative to the input Nyquist, below the output Nyquist when downsampling
+	const double cutoff = std::min(1.0, 1.0 / ratio);
+	const double halfWidth = halfTaps / cutoff;
+
+	// the windowed sinc (Blackman-Harris window), tabulated at `oversampling` points per input sample over
+	// [-halfWidth, halfWidth] and linearly interpolated, so there are no transcendentals per tap
+	const int oversampling = 512;
+	std::vector<float> table((size_t) std::ceil(2 * halfWidth * oversampling) + 2);
+	for (size_t j = 0; j < table.size(); j++) {
+		const double x = (double) j / oversampling - halfWidth;
+		const double p = clamp(0.5 + 0.5 * x / halfWidth, 0.0, 1.0);
+		const double window = 0.35875 - 0.48829 * std::cos(2 * M_PI * p) + 0.14128 * std::cos(4 * M_PI * p) - 0.01168 * std::cos(6 * M_PI * p);
+		table[j] = cutoff * rack::dsp::sinc(cutoff * x) * window;
+	}
+
+	std::vector<float> resampled((size_t) std::ceil(length / ratio));
+	for (size_t i = 0; i < resampled.size(); i++) {
+		const double t = i * ratio;
+		const int begin = std::max(0, (int) std::ceil(t - halfWidth));
+		const int end = std::min((int) length - 1, (int) std::floor(t + halfWidth));
+		// table position of the first tap, which moves back by `oversampling` for each following tap
+		double position = (t - begin + halfWidth) * oversampling;
+		double sum = 0.0;
+		for (int k = begin; k <= end; k++, position -= oversampling) {
+			const int j = (int) position;
+			const float frac = position - j;
+			sum += kernel[k] * (table[j] + (table[j + 1] - table[j]) * frac);
+		}
+		resampled[i] = sum * ratio;
+	}
+	return resampled;
+}
+
+// the impulse response at the given sample rate, partitioned for a PartitionedConvolver with BLOCK_SIZE head blocks.
+// Kernel spectra are immutable and shared by all instances running at the same rate, and are freed once the last
+// instance using them changes rate or is removed.
+static std::shared_ptr<const PartitionedKernel> getKernel(float sampleRate) {
+	static std::mutex mutex;
+	static std::map<int, std::weak_ptr<const PartitionedKernel>> cache;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	// drop entries for kernels that have been freed, so the cache doesn't grow with each rate ever used
+	for (auto it = cache.begin(); it != cache.end();) {
+		if (it->second.expired()) {
+			it = cache.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	const int key = std::round(sampleRate);
+	std::shared_ptr<const PartitionedKernel> partitioned = cache[key].lock();
+	if (partitioned) {
+		return partitioned;
+	}
+
+	const float* kernel = (const float*) BINARY_START(src_SpringReverbIR_pcm);
+	const size_t kernelLen = BINARY_SIZE(src_SpringReverbIR_pcm) / sizeof(float);
+	if (key == (int) KERNEL_SAMPLE_RATE) {
+		partitioned = PartitionedKernel::create(kernel, kernelLen, BLOCK_SIZE, TAIL_BLOCK_SIZE);
+	}
+	else {
+		const std::vector<float> resampled = resampleKernel(kernel, kernelLen, KERNEL_SAMPLE_RATE, key);
+		partitioned = PartitionedKernel::create(resampled.data(), resampled.size(), BLOCK_SIZE, TAIL_BLOCK_SIZE);
+	}
+	cache[key] = partitioned;
+	return partitioned;
+}
+
+
+/** Single producer, single consumer lock-free queue of blocks, which are written and read in place (rather than
+copied in and out, as with dsp::RingBuffer) as they're too large to pass through the stack.
+*/
+template <typename T, size_t S>
+struct BlockQueue {
+	T blocks[S];
+	std::atomic<size_t> start{0};
+	std::atomic<size_t> end{0};
+
+	bool empty() const {
+		return start == end;
+	}
+	bool full() const {
+		return end - start >= S;
+	}
+	/** The block to write before push(), the queue must not be full. */
+	T& back() {
+		return blocks[end % S];
+	}
+	void push() {
+		end++;
+	}
+	/** The oldest block, to read before pop(), the queue must not be empty. */
+	T& front() {
+		return blocks[start % S];
+	}
+	void pop() {
+		start++;
+	}
+};
+
+
+// Rack only enables flush-to-zero and denormals-are-zero on its own engine threads
+static void enableFlushToZero() {
+#if defined ARCH_X64
+	_MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+	_MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+#elif defined ARCH_ARM64
+	uint64_t fpcr;
+	__asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+	// FZ bit
+	fpcr |= (1 << 24);
+	__asm__ volatile("msr fpcr, %0" :: "r"(fpcr));
+#endif
+}
+
+
+/** Runs a PartitionedConvolver on a background thread. Blocks of WORKER_BLOCK_SIZE input samples (per channel) are
+handed to the worker through a lock-free single producer, single consumer queue, and the output of each block is
+collected when the following block is sent, so the audio thread never waits on the convolution (or takes a lock).
+If the worker falls behind, silence is output in place of the missing block and late blocks are discarded, so that
+latency stays fixed.
+
+The thread is started and stopped off the audio thread, with start() and stopIfUnused(). The audio thread claims the
+worker with acquire() before sending blocks, and gives it back with release() once it is idle, so the thread can only
+be stopped while the audio thread isn't using it.
+*/
+struct ConvolutionWorker {
+	struct Block {
+		uint64_t index;
+		int channels;
+		// channel-major, i.e. sample i of channel c is at [c * WORKER_BLOCK_SIZE + i]
+		float samples[PORT_MAX_CHANNELS * WORKER_BLOCK_SIZE];
+	};
+
+	PartitionedConvolver* convolver;
+	BlockQueue<Block, 4> inputQueue;
+	BlockQueue<Block, 4> outputQueue;
+	// blocks sent to the worker that it hasn't finished processing
+	std::atomic<int> pendingBlocks{0};
+
+	// audio thread state
+	uint64_t nextIndex = 0;
+
+	// worker thread state, a head block of input and output
+	float convolverInput[PORT_MAX_CHANNELS * BLOCK_SIZE];
+	float convolverOutput[PORT_MAX_CHANNELS * BLOCK_SIZE];
+
+	enum State {
+		STOPPED,
+		RUNNING,
+		// running, and claimed by the audio thread
+		IN_USE
+	};
+	std::atomic<int> state{STOPPED};
+	std::thread thread;
+
+	ConvolutionWorker(PartitionedConvolver* convolver) : convolver(convolver) {
+	}
+
+	~ConvolutionWorker() {
+		// the module is no longer being processed, so the audio thread can't be using the worker
+		state = STOPPED;
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+	/** Starts the thread if it isn't running. Not to be called from the audio thread. */
+	void start() {
+		if (state != STOPPED) {
+			return;
+		}
+		state = RUNNING;
+		thread = std::thread(&ConvolutionWorker::run, this);
+	}
+
+	/** Stops the thread, unless the audio thread is using it. Not to be called from the audio thread. */
+	void stopIfUnused() {
+		int expected = RUNNING;
+		if (state.compare_exchange_strong(expected, STOPPED)) {
+			thread.join();
+		}
+	}
+
+	/** Called by the audio thread before sending blocks, returns false if the thread isn't running. */
+	bool acquire() {
+		int expected = RUNNING;
+		return state.compare_exchange_strong(expected, IN_USE);
+	}
+
+	/** Called by the audio thread once it has stopped sending blocks and the worker is idle. */
+	void release() {
+		state = RUNNING;
+	}
+
+	/** True if the worker has finished with the convolver. */
+	bool isIdle() const {
+		return pendingBlocks == 0;
+	}
+
+	/** Waits for the worker to finish with the convolver, when no more blocks are being sent. */
+	void waitUntilIdle() const {
+		while (!isIdle()) {
+			std::this_thread::yield();
+		}
+	}
+
+	/** Discards any output not yet collected. The worker must be idle. */
+	void reset() {
+		while (!outputQueue.empty()) {
+			outputQueue.pop();
+		}
+		nextIndex = 0;
+	}
+
+	/** Sends a block of WORKER_BLOCK_SIZE samples per channel to the worker, and collects the output of the previous
+	block. Channel data is laid out as for Block::samples.
+	*/
+	void processBlock(const float* input, float* output, int channels) {
+		const uint64_t index = nextIndex++;
+
+		if (!inputQueue.full()) {
+			Block& block = inputQueue.back();
+			block.index = index;
+			block.channels = channels;
+			std::memcpy(block.samples, input, sizeof(float) * channels * WORKER_BLOCK_SIZE);
+			pendingBlocks++;
+			inputQueue.push();
+		}
+
+		// skip output that arrived too late
+		while (!outputQueue.empty() && outputQueue.front().index + 1 < index) {
+			outputQueue.pop();
+		}
+
+		int receivedChannels = 0;
+		if (!outputQueue.empty() && outputQueue.front().index + 1 == index) {
+			const Block& received = outputQueue.front();
+			receivedChannels = std::min(received.channels, channels);
+			std::memcpy(output, received.samples, sizeof(float) * receivedChannels * WORKER_BLOCK_SIZE);
+			outputQueue.pop();
+		}
+		// channels that are missing (or weren't present in the previous block) are silent
+		std::memset(&output[receivedChannels * WORKER_BLOCK_SIZE], 0, sizeof(float) * (channels - receivedChannels) * WORKER_BLOCK_SIZE);
+	}
+
+private:
+	void run() {
+		// the decaying reverb tail would otherwise be processed as denormals
+		enableFlushToZero();
+
+		while (state != STOPPED) {
+			if (inputQueue.empty()) {
+				std::this_thread::sleep_for(WORKER_POLL_INTERVAL);
+				continue;
+			}
+
+			while (!inputQueue.empty()) {
+				const Block& block = inputQueue.front();
+				// if the audio thread isn't collecting output, drop it
+				Block* output = outputQueue.full() ? NULL : &outputQueue.back();
+
+				convolver->setChannels(block.channels);
+				for (size_t i = 0; i < WORKER_BLOCK_SIZE; i += BLOCK_SIZE) {
+					for (int c = 0; c < block.channels; c++) {
+						std::memcpy(&convolverInput[c * BLOCK_SIZE], &block.samples[c * WORKER_BLOCK_SIZE + i], sizeof(float) * BLOCK_SIZE);
+					}
+					convolver->processBlock(convolverInput, convolverOutput);
+					for (int c = 0; output && c < block.channels; c++) {
+						std::memcpy(&output->samples[c * WORKER_BLOCK_SIZE + i], &convolverOutput[c * BLOCK_SIZE], sizeof(float) * BLOCK_SIZE);
+					}
+				}
+
+				if (output) {
+					output->index = block.index;
+					output->channels = block.channels;
+					outputQueue.push();
+				}
+				inputQueue.pop();
+				pendingBlocks--;
+			}
+		}
+	}
+};
+
+
+/** Algorithmic spring reverb, a low CPU (and zero latency) alternative to convolving with the impulse response.
+A feedback delay line with the spring's round trip time, where each trip passes through a cascade of stretched
+allpass filters (which disperse it into the characteristic chirp, with high frequencies arriving later) and a
+lowpass filter. The loop delay is slowly modulated to avoid metallic ringing. See Valimaki, Parker and Abel,
+"Parametric Spring Reverberation Effect", JAES 2010. Constants are tuned by ear and by measurement to
+approximate SpringReverbIR.pcm: 48ms round trip, ~6.5s RT60 and little energy above 4kHz.
+
+Processes 4 channels in parallel.
+*/
+struct SpringModel {
+	static const int NUM_ALLPASSES = 24;
+	// stretched allpass coefficient, controls the chirp shape
+	const float allpassCoeff = 0.65f;
+	const float roundTripTime = 0.048f;
+	const float rt60 = 6.5f;
+	const float lowpassCutoff = 4500.f;
+	// loop delay modulation, in seconds and Hz
+	const float modulationDepth = 0.0001f;
+	const float modulationRate = 0.7f;
+	// matches the level of the convolution engine
+	const float outputGain = 16.f;
+
+	// allpass states, indexed [i * NUM_ALLPASSES + stage] for the stretched delay of `allpassDelay` samples
+	std::vector<float_4> allpassState;
+	int allpassDelay = 1;
+	int allpassPos = 0;
+
+	std::vector<float_4> delayLine;
+	int delayMask = 0;
+	int writePos = 0;
+	float loopDelay = 0.f;
+	float modulationSamples = 0.f;
+
+	float_4 lowpassState = 0.f;
+	float lowpassCoeff = 0.f;
+	float feedback = 0.f;
+
+	float lfoPhase = 0.f;
+	float lfoStep = 0.f;
+
+	void setSampleRate(float sampleRate) {
+		// the allpass stretch sets the frequency at which dispersion peaks (the "transition frequency"), here ~4kHz
+		allpassDelay = std::max(1, (int) std::round(sampleRate / 8000.f));
+		allpassState.assign(allpassDelay * NUM_ALLPASSES, 0.f);
+		allpassPos = 0;
+
+		// the allpass chain adds some delay at low frequencies, which is taken from the loop
+		const float allpassGroupDelay = NUM_ALLPASSES * allpassDelay * (1.f - allpassCoeff) / (1.f + allpassCoeff);
+		loopDelay = roundTripTime * sampleRate - allpassGroupDelay;
+		modulationSamples = modulationDepth * sampleRate;
+
+		const int delayLength = 1 << (int) std::ceil(std::log2(loopDelay + modulationSamples + 2));
+		delayLine.assign(delayLength, 0.f);
+		delayMask = delayLength - 1;
+		writePos = 0;
+
+		lowpassCoeff = std::exp(-2.f * M_PI * lowpassCutoff / sampleRate);
+		lowpassState = 0.f;
+		feedback = std::pow(10.f, -3.f * roundTripTime / rt60);
+		lfoStep = modulationRate / sampleRate;
+	}
+
+	void reset() {
+		std::fill(allpassState.begin(), allpassState.end(), 0.f);
+		std::fill(delayLine.begin(), delayLine.end(), 0.f);
+		lowpassState = 0.f;
+	}
+
+	float_4 process(float_4 in) {
+		// feedback from the far end of the spring, with modulated delay
+		const float modulation = modulationSamples * std::sin(2.f * M_PI * lfoPhase);
+		lfoPhase += lfoStep;
+		lfoPhase -= std::floor(lfoPhase);
+		const float_4 fromSpring = readDelay(loopDelay + modulation);
+		lowpassState = fromSpring + lowpassCoeff * (lowpassState - fromSpring);
+
+		float_4 x = in + feedback * lowpassState;
+
+		// dispersion: y[n] = a * v[n] + v[n - K], v[n] = x[n] - a * v[n - K]
+		float_4* state = &allpassState[allpassPos * NUM_ALLPASSES];
+		for (int stage = 0; stage < NUM_ALLPASSES; stage++) {
+			const float_4 delayed = state[stage];
+			const float_4 v = x - allpassCoeff * delayed;
+			x = allpassCoeff * v + delayed;
+			state[stage] = v;
+		}
+		if (++allpassPos == allpassDelay) {
+			allpassPos = 0;
+		}
+
+		delayLine[writePos] = x;
+		writePos = (writePos + 1) & delayMask;
 
-static const size_t BLOCK_SIZE = 1024;
+		// the output is picked up half way round the loop
+		return outputGain * readDelay(0.5f * loopDelay);
+	}
+
+private:
+	// linearly interpolated read, `delay` samples before the next write
+	float_4 readDelay(float delay) const {
+		const float position = writePos - delay;
+		const int i = (int) std::floor(position);
+		const float frac = position - i;
+		const float_4 a = delayLine[i & delayMask];
+		const float_4 b = delayLine[(i + 1) & delayMask];
+		return a + (b - a) * frac;
+	}
+};
 
 
 struct SpringReverb : Module {
@@ -34,13 +458,45 @@ struct SpringReverb : Module {
 		NUM_LIGHTS
 	};
 
-	dsp::RealTimeConvolver* convolver = NULL;
-	dsp::SampleRateConverter<1> inputSrc;
-	dsp::SampleRateConverter<1> outputSrc;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 16 * BLOCK_SIZE> inputBuffer;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 16 * BLOCK_SIZE> outputBuffer;
-
-	dsp::RCFilter dryFilter;
+	PartitionedConvolver* convolver = NULL;
+	// created (off the audio thread) the first time the worker thread is enabled, as it holds ~512KB of buffers
+	std::unique_ptr<ConvolutionWorker> worker;
+	// user setting (see setUseWorkerThread()), and the mode currently in use (which only changes once the worker is idle)
+	std::atomic<bool> useWorkerThread{false};
+	bool usingWorkerThread = false;
+
+	enum Engine {
+		CONVOLUTION_ENGINE,
+		SPRING_MODEL_ENGINE,
+		NUM_ENGINES
+	};
+	// user setting, and the engine in use
+	Engine engine = CONVOLUTION_ENGINE;
+	Engine activeEngine = CONVOLUTION_ENGINE;
+	// algorithmic engine, for groups of 4 channels
+	SpringModel springModels[4];
+
+	// in polyphonic mode each input channel has its own reverb, otherwise inputs are summed to mono (see setPolyphonic())
+	std::atomic<bool> polyphonic{false};
+
+	// the block being filled with input, and the block of output being played, channel-major
+	// (sample i of channel c is at [c * getBlockSize() + i])
+	float inputBlock[PORT_MAX_CHANNELS * WORKER_BLOCK_SIZE] = {};
+	float outputBlock[PORT_MAX_CHANNELS * WORKER_BLOCK_SIZE] = {};
+	size_t blockPos = 0;
+	// number of channels in the current block
+	int channels = 1;
+
+	// peak input and output levels (over all channels) in the current block, for silence detection
+	float blockInputPeak = 0.f;
+	float blockOutputPeak = 0.f;
+	// samples of input that have been silent
+	size_t silentSamples = 0;
+	// true if convolution is skipped, as both input and output are silent
+	bool sleeping = false;
+	float sampleRate = 48000.f;
+
+	dsp::RCFilter dryFilter[PORT_MAX_CHANNELS];
 
 	dsp::VuMeter2 vuFilter;
 	dsp::VuMeter2 lightFilter;
@@ -55,11 +511,8 @@ struct SpringReverb : Module {
 		configParam(LEVEL2_PARAM, 0.0, 1.0, 0.0, "In 2 level", "%", 0, 100);
 		configParam(HPF_PARAM, 0.0, 1.0, 0.5, "High pass filter cutoff");
 
-		convolver = new dsp::RealTimeConvolver(BLOCK_SIZE);
-
-		const float* kernel = (const float*) BINARY_START(src_SpringReverbIR_pcm);
-		size_t kernelLen = BINARY_SIZE(src_SpringReverbIR_pcm) / sizeof(float);
-		convolver->setKernel(kernel, kernelLen);
+		convolver = new PartitionedConvolver(BLOCK_SIZE, TAIL_BLOCK_SIZE);
+		onSampleRateChange();
 
 		vuFilter.mode = dsp::VuMeter2::PEAK;
 		lightFilter.mode = dsp::VuMeter2::PEAK;
@@ -68,81 +521,268 @@ struct SpringReverb : Module {
 	}
 
 	~SpringReverb() {
+		worker.reset();
 		delete convolver;
 	}
 
+	void onSampleRateChange() override {
+		sampleRate = APP->engine->getSampleRate();
+
+		// the worker mustn't be using the convolver while the kernel is replaced
+		if (usingWorkerThread) {
+			worker->waitUntilIdle();
+			worker->reset();
+		}
+		convolver->setKernel(getKernel(sampleRate));
+		for (int g = 0; g < 4; g++) {
+			springModels[g].setSampleRate(sampleRate);
+		}
+
+		std::fill(std::begin(inputBlock), std::end(inputBlock), 0.f);
+		std::fill(std::begin(outputBlock), std::end(outputBlock), 0.f);
+		blockPos = 0;
+	}
+
+	size_t getBlockSize() const {
+		return usingWorkerThread ? WORKER_BLOCK_SIZE : BLOCK_SIZE;
+	}
+
+	size_t getLatency() const {
+		if (activeEngine == SPRING_MODEL_ENGINE) {
+			return 0;
+		}
+		return usingWorkerThread ? 2 * WORKER_BLOCK_SIZE : BLOCK_SIZE;
+	}
+
+	/** Latency of the reverb, in ms. */
+	float getLatencyMs() const {
+		return 1000.f * getLatency() / sampleRate;
+	}
+
+	/** Enables or disables convolution on the worker thread. The worker is created the first time it is enabled, and
+	its thread started here (or stopped once the audio thread has finished with it, see SpringReverbWidget::step()).
+	Not to be called from the audio thread.
+	*/
+	void setUseWorkerThread(bool use) {
+		if (use) {
+			// the audio thread only uses the worker once it sees useWorkerThread set, below
+			if (!worker) {
+				worker.reset(new ConvolutionWorker(convolver));
+			}
+			worker->start();
+		}
+		useWorkerThread = use;
+		if (!use && worker) {
+			worker->stopIfUnused();
+		}
+	}
+
+	/** Enables or disables polyphonic mode. The convolver's state for all channels is allocated (once) here, so that
+	channels can be added on the audio thread without allocating. Not to be called from the audio thread.
+	*/
+	void setPolyphonic(bool poly) {
+		if (poly) {
+			convolver->reserveChannels(PORT_MAX_CHANNELS);
+		}
+		polyphonic = poly;
+	}
+
+	// switches between convolving on the audio thread and the worker thread, returns false while
+	// switching (including for the block in which the switch happens, which is of the previous size)
+	bool updateConvolutionMode() {
+		const bool use = useWorkerThread;
+		if (use == usingWorkerThread) {
+			return true;
+		}
+		if (use) {
+			// the thread may have just been stopped, in which case carry on convolving here
+			if (!worker->acquire()) {
+				return true;
+			}
+			worker->reset();
+			convolver->reset();
+			usingWorkerThread = true;
+		}
+		else if (worker->isIdle()) {
+			worker->reset();
+			convolver->reset();
+			usingWorkerThread = false;
+			worker->release();
+		}
+		return false;
+	}
+
+	// returns true if convolution can be skipped for this block, which is the case once the input has been silent for
+	// longer than the impulse response (so the reverb tail has played out) and the output has decayed
+	bool updateSleeping() {
+		if (blockInputPeak >= SILENCE_THRESHOLD) {
+			silentSamples = 0;
+			sleeping = false;
+		}
+		else {
+			silentSamples += getBlockSize();
+		}
+
+		const bool tailFinished = silentSamples > convolver->kernelLength + getLatency() && blockOutputPeak < SILENCE_THRESHOLD;
+		if (!sleeping && tailFinished && (!usingWorkerThread || worker->isIdle())) {
+			// what remains in the convolver is negligible, so clear it and output silence until input returns
+			if (usingWorkerThread) {
+				worker->reset();
+			}
+			convolver->reset();
+			std::fill(outputBlock, outputBlock + PORT_MAX_CHANNELS * getBlockSize(), 0.f);
+			sleeping = true;
+		}
+
+		blockInputPeak = 0.f;
+		blockOutputPeak = 0.f;
+		return sleeping;
+	}
+
+	void processBlock() {
+		if (!updateConvolutionMode()) {
+			std::fill(outputBlock, outputBlock + channels * getBlockSize(), 0.f);
+			blockInputPeak = 0.f;
+			blockOutputPeak = 0.f;
+			sleeping = false;
+		}
+		else if (updateSleeping()) {
+			// output block is already silent
+		}
+		else if (usingWorkerThread) {
+			worker->processBlock(inputBlock, outputBlock, channels);
+		}
+		else {
+			convolver->setChannels(channels);
+			convolver->processBlock(inputBlock, outputBlock);
+		}
+	}
+
+	int getInputChannels() {
+		return polyphonic ? std::max({1, inputs[IN1_INPUT].getChannels(), inputs[IN2_INPUT].getChannels()}) : 1;
+	}
+
+	// in mono mode, polyphonic inputs are summed
+	float getInputVoltage(int inputId, int c) {
+		return polyphonic ? inputs[inputId].getPolyVoltage(c) : inputs[inputId].getVoltageSum();
+	}
+
 	void processBypass(const ProcessArgs& args) override {
-		float in1 = inputs[IN1_INPUT].getVoltageSum();
-		float in2 = inputs[IN2_INPUT].getVoltageSum();
+		const int bypassChannels = getInputChannels();
+		for (int c = 0; c < bypassChannels; c++) {
+			float in1 = getInputVoltage(IN1_INPUT, c);
+			float in2 = getInputVoltage(IN2_INPUT, c);
 
-		float dry = clamp(in1 + in2, -10.0f, 10.0f);
+			float dry = clamp(in1 + in2, -10.0f, 10.0f);
 
-		outputs[WET_OUTPUT].setVoltage(dry);
-		outputs[MIX_OUTPUT].setVoltage(dry);
+			outputs[WET_OUTPUT].setVoltage(dry, c);
+			outputs[MIX_OUTPUT].setVoltage(dry, c);
+		}
+		outputs[WET_OUTPUT].setChannels(bypassChannels);
+		outputs[MIX_OUTPUT].setChannels(bypassChannels);
 	}
 
 	void process(const ProcessArgs& args) override {
-		float in1 = inputs[IN1_INPUT].getVoltageSum();
-		float in2 = inputs[IN2_INPUT].getVoltageSum();
-		const float levelScale = 0.030;
-		const float levelBase = 25.0;
-		float level1 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL1_PARAM].getValue()) * inputs[CV1_INPUT].getNormalVoltage(10.0) / 10.0;
-		float level2 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL2_PARAM].getValue()) * inputs[CV2_INPUT].getNormalVoltage(10.0) / 10.0;
-		float dry = in1 * level1 + in2 * level2;
-
-		// HPF on dry
-		float dryCutoff = 200.0 * std::pow(20.0, params[HPF_PARAM].getValue()) * args.sampleTime;
-		dryFilter.setCutoff(dryCutoff);
-		dryFilter.process(dry);
-
-		// Add dry to input buffer
-		if (!inputBuffer.full()) {
-			dsp::Frame<1> inputFrame;
-			inputFrame.samples[0] = dryFilter.highpass();
-			inputBuffer.push(inputFrame);
-		}
-
-
-		if (outputBuffer.empty()) {
-			float input[BLOCK_SIZE] = {};
-			float output[BLOCK_SIZE];
-			// Convert input buffer
-			{
-				inputSrc.setRates(args.sampleRate, 48000);
-				int inLen = inputBuffer.size();
-				int outLen = BLOCK_SIZE;
-				inputSrc.process(inputBuffer.startData(), &inLen, (dsp::Frame<1>*) input, &outLen);
-				inputBuffer.startIncr(inLen);
+		if (engine != activeEngine) {
+			// restart the engine being switched to, so it doesn't play out stale state
+			if (engine == SPRING_MODEL_ENGINE) {
+				for (int g = 0; g < 4; g++) {
+					springModels[g].reset();
+				}
 			}
+			else {
+				// as in updateConvolutionMode(), the worker must have finished with the convolver before it's cleared
+				if (usingWorkerThread) {
+					worker->waitUntilIdle();
+					worker->reset();
+				}
+				convolver->reset();
+				std::fill(std::begin(inputBlock), std::end(inputBlock), 0.f);
+			}
+			std::fill(std::begin(outputBlock), std::end(outputBlock), 0.f);
+			blockPos = 0;
+			activeEngine = engine;
+		}
+		const bool useSpringModel = (activeEngine == SPRING_MODEL_ENGINE);
+
+		const size_t blockSize = getBlockSize();
+		// when convolving, the channel count can only change between blocks
+		if (useSpringModel || blockPos == 0) {
+			const int newChannels = getInputChannels();
+			// the output of channels that weren't convolved in the previous block is silent
+			for (int c = channels; c < newChannels && !useSpringModel; c++) {
+				std::fill(&outputBlock[c * blockSize], &outputBlock[(c + 1) * blockSize], 0.f);
+			}
+			channels = newChannels;
+		}
 
-			// Convolve block
-			convolver->processBlock(input, output);
+		const float levelScale = 0.030;
+		const float levelBase = 25.0;
+		const float levelParam1 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL1_PARAM].getValue());
+		const float levelParam2 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL2_PARAM].getValue());
+		const float dryCutoff = 200.0 * std::pow(20.0, params[HPF_PARAM].getValue()) * args.sampleTime;
+
+		// peak (absolute) levels over all channels, for the lights
+		float wetPeak = 0.f;
+		float dryPeak = 0.f;
+
+		float in1[PORT_MAX_CHANNELS];
+		float_4 input[4] = {};
+		float_4 wet[4] = {};
+
+		for (int c = 0; c < channels; c++) {
+			in1[c] = getInputVoltage(IN1_INPUT, c);
+			float in2 = getInputVoltage(IN2_INPUT, c);
+			float level1 = levelParam1 * inputs[CV1_INPUT].getNormalPolyVoltage(10.0, c) / 10.0;
+			float level2 = levelParam2 * inputs[CV2_INPUT].getNormalPolyVoltage(10.0, c) / 10.0;
+			float dry = in1[c] * level1 + in2 * level2;
+
+			// HPF on dry
+			dryFilter[c].setCutoff(dryCutoff);
+			dryFilter[c].process(dry);
+			input[c / 4].s[c % 4] = dryFilter[c].highpass();
+
+			dryPeak = std::max(dryPeak, std::fabs(dry));
+		}
 
-			// Convert output buffer
-			{
-				outputSrc.setRates(48000, args.sampleRate);
-				int inLen = BLOCK_SIZE;
-				int outLen = outputBuffer.capacity();
-				outputSrc.process((dsp::Frame<1>*) output, &inLen, outputBuffer.endData(), &outLen);
-				outputBuffer.endIncr(outLen);
+		if (useSpringModel) {
+			for (int c = 0; c < channels; c += 4) {
+				wet[c / 4] = springModels[c / 4].process(input[c / 4]);
+			}
+		}
+		else {
+			// Add dry to input block, and take wet from output block
+			for (int c = 0; c < channels; c++) {
+				inputBlock[c * blockSize + blockPos] = input[c / 4].s[c % 4];
+				wet[c / 4].s[c % 4] = outputBlock[c * blockSize + blockPos];
+				blockInputPeak = std::max(blockInputPeak, std::fabs(input[c / 4].s[c % 4]));
 			}
 		}
 
-		// Set output
-		if (outputBuffer.empty())
-			return;
+		for (int c = 0; c < channels; c++) {
+			float balance = clamp(params[WET_PARAM].getValue() + inputs[MIX_CV_INPUT].getPolyVoltage(c) / 10.0f, 0.0f, 1.0f);
+			float mix = crossfade(in1[c], wet[c / 4].s[c % 4], balance);
 
-		float wet = outputBuffer.shift().samples[0];
-		float balance = clamp(params[WET_PARAM].getValue() + inputs[MIX_CV_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
-		float mix = crossfade(in1, wet, balance);
+			outputs[WET_OUTPUT].setVoltage(clamp(wet[c / 4].s[c % 4], -10.0f, 10.0f), c);
+			outputs[MIX_OUTPUT].setVoltage(clamp(mix, -10.0f, 10.0f), c);
 
-		outputs[WET_OUTPUT].setVoltage(clamp(wet, -10.0f, 10.0f));
-		outputs[MIX_OUTPUT].setVoltage(clamp(mix, -10.0f, 10.0f));
+			wetPeak = std::max(wetPeak, std::fabs(wet[c / 4].s[c % 4]));
+		}
+		outputs[WET_OUTPUT].setChannels(channels);
+		outputs[MIX_OUTPUT].setChannels(channels);
+
+		if (!useSpringModel) {
+			blockOutputPeak = std::max(blockOutputPeak, wetPeak);
+			if (++blockPos >= blockSize) {
+				blockPos = 0;
+				processBlock();
+			}
+		}
 
 		// process VU lights
-		vuFilter.process(args.sampleTime, wet);
+		vuFilter.process(args.sampleTime, wetPeak);
 		// process peak light
-		lightFilter.process(args.sampleTime, dry * 50.0);
+		lightFilter.process(args.sampleTime, dryPeak * 50.0);
 
 		if (lightRefreshClock.process()) {
 
@@ -154,6 +794,31 @@ struct SpringReverb : Module {
 			lights[PEAK_LIGHT].value = lightFilter.v;
 		}
 	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "useWorkerThread", json_boolean(useWorkerThread.load()));
+		json_object_set_new(rootJ, "polyphonic", json_boolean(polyphonic.load()));
+		json_object_set_new(rootJ, "engine", json_integer(engine));
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* useWorkerThreadJ = json_object_get(rootJ, "useWorkerThread");
+		if (useWorkerThreadJ) {
+			setUseWorkerThread(json_boolean_value(useWorkerThreadJ));
+		}
+
+		json_t* polyphonicJ = json_object_get(rootJ, "polyphonic");
+		if (polyphonicJ) {
+			setPolyphonic(json_boolean_value(polyphonicJ));
+		}
+
+		json_t* engineJ = json_object_get(rootJ, "engine");
+		if (engineJ) {
+			engine = (Engine) clamp((int) json_integer_value(engineJ), 0, NUM_ENGINES - 1);
+		}
+	}
 };
 
 
@@ -192,6 +857,39 @@ struct SpringReverbWidget : ModuleWidget {
 		addChild(createLight<MediumLight<GreenLight>>(Vec(55, 175), module, SpringReverb::VU1_LIGHTS + 5));
 		addChild(createLight<MediumLight<GreenLight>>(Vec(55, 188), module, SpringReverb::VU1_LIGHTS + 6));
 	}
+
+	void step() override {
+		SpringReverb* module = dynamic_cast<SpringReverb*>(this->module);
+		// once the worker thread has been disabled and the audio thread has finished with it, stop it
+		if (module && !module->useWorkerThread && module->worker) {
+			module->worker->stopIfUnused();
+		}
+		ModuleWidget::step();
+	}
+
+	void appendContextMenu(Menu* menu) override {
+		SpringReverb* module = dynamic_cast<SpringReverb*>(this->module);
+		assert(module);
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(createMenuLabel("Engine"));
+		const std::string engineNames[SpringReverb::NUM_ENGINES] = {"Convolution", "Spring model (low CPU)"};
+		for (int i = 0; i < SpringReverb::NUM_ENGINES; i++) {
+			const SpringReverb::Engine engine = (SpringReverb::Engine) i;
+			menu->addChild(createMenuItem(engineNames[i], CHECKMARK(module->engine == engine), [ = ]() {
+				module->engine = engine;
+			}));
+		}
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(createMenuItem("Polyphonic", CHECKMARK(module->polyphonic), [ = ]() {
+			module->setPolyphonic(!module->polyphonic);
+		}));
+		menu->addChild(createMenuItem("Convolve on worker thread", CHECKMARK(module->useWorkerThread), [ = ]() {
+			module->setUseWorkerThread(!module->useWorkerThread);
+		}));
+		menu->addChild(createMenuLabel(string::f("Latency: %.1f ms", module->getLatencyMs())));
+	}
 };
 
 
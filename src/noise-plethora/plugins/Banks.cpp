@@ -1,46 +1,28 @@
 #include "Banks.hpp"
 #include "Banks_Def.hpp"
+#include "NoisePlethoraPlugin.hpp"
 
-const Bank::BankElem Bank::defaultElem = {"", 1.0};
-
-Bank::Bank() {
-	programs.fill(defaultElem);
-}
-
-Bank::Bank(const BankElem& p1, const BankElem& p2, const BankElem& p3,
-           const BankElem& p4, const BankElem& p5, const BankElem& p6,
-           const BankElem& p7, const BankElem& p8, const BankElem& p9,
-           const BankElem& p10)
-	: programs{p1, p2, p3, p4, p5, p6, p7, p8, p9, p10}
-{ }
-
-const std::string Bank::getProgramName(int i) {
-	if (i >= 0 && i < programsPerBank) {
+const char* Bank::getProgramName(int i) const {
+	if (i >= 0 && i < size) {
 		return programs[i].name;
 	}
 	return "";
 }
 
-float Bank::getProgramGain(int i) {
-	if (i >= 0 && i < programsPerBank) {
+float Bank::getProgramGain(int i) const {
+	if (i >= 0 && i < size) {
 		return programs[i].gain;
 	}
 	return 1.0;
 }
 
-int Bank::getSize() {
-	int size = 0;
-	for (auto it = programs.begin(); it != programs.end(); it++) {
-		if ((*it).name == "") {
-			break;
-		}
-		size++;
+NoisePlethoraPlugin* Bank::createProgram(int i) const {
+	if (i >= 0 && i < size) {
+		return programs[i].create();
 	}
-	return size;
+	return nullptr;
 }
 
-
-
 // Bank A:
 #include "P_radioOhNo.hpp"
 #include "P_Rwalk_SineFMFlange.hpp"
@@ -89,24 +71,30 @@ int Bank::getSize() {
 //#include "P_Rwalk_WaveTwist.hpp"
 
 
-static const Bank bank1 BANKS_DEF_1; // Banks_Def.hpp
-static const Bank bank2 BANKS_DEF_2;
-static const Bank bank3 BANKS_DEF_3;
-//static const Bank bank4 BANKS_DEF_4;
-//static const Bank bank5 BANKS_DEF_5;
-static std::array<Bank, numBanks> banks { bank1, bank2, bank3 }; //, bank5 };
-
-// static const Bank bank6 BANKS_DEF_6;
-// static const Bank bank7 BANKS_DEF_7;
-// static const Bank bank8 BANKS_DEF_8;
-// static const Bank bank9 BANKS_DEF_9;
-// static const Bank bank10 BANKS_DEF_10;
-// static std::array<Bank, programsPerBank> banks { bank1, bank2, bank3, bank4, bank5, bank6, bank7, bank8, bank9, bank10 };
+// the algorithm table is built at compile time, row i is bank i (see Banks_Def.hpp)
+static constexpr Bank::BankElem programs[numBanks][programsPerBank] = {
+	BANKS_DEF_1,
+	BANKS_DEF_2,
+	BANKS_DEF_3
+	//, BANKS_DEF_4
+};
+static constexpr Bank banks[numBanks] = { Bank(programs[0]), Bank(programs[1]), Bank(programs[2]) };
 
-Bank& getBankForIndex(int i) {
+const Bank& getBankForIndex(int i) {
 	if (i < 0)
 		i = 0;
-	if (i >= programsPerBank)
-		i = (programsPerBank - 1);
+	if (i >= numBanks)
+		i = (numBanks - 1);
 	return banks[i];
 }
+
+int findAlgorithmId(const std::string& name) {
+	for (int bank = 0; bank < numBanks; ++bank) {
+		for (int program = 0; program < banks[bank].getSize(); ++program) {
+			if (name == banks[bank].getProgramName(program)) {
+				return getAlgorithmId(bank, program);
+			}
+		}
+	}
+	return -1;
+}
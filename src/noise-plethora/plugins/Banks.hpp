@@ -1,44 +1,59 @@
 #pragma once
 
 #include <string>
-#include <memory>
-#include <array>
+
+class NoisePlethoraPlugin;
 
 static const int programsPerBank = 10;
 static const int numBanks = 3;
 
-struct Bank {
+// every program slot has a dense integer ID, bank * programsPerBank + program
+static const int numAlgorithms = numBanks * programsPerBank;
 
-	struct BankElem {
-		BankElem() {};
+template <class T>
+NoisePlethoraPlugin* createAlgorithm() {
+	return new T();
+}
 
-		BankElem(std::string n, float g = 1.0)
-			: name{n}
-			, gain{g}
-		{}
+struct Bank {
 
-		std::string name = "";
-		float gain = 1.0;
+	// entry in the compile-time algorithm table (see Banks_Def.hpp), an empty slot has name == nullptr
+	struct BankElem {
+		const char* name;
+		float gain;
+		NoisePlethoraPlugin* (*create)();
 	};
 
-	static const BankElem defaultElem;
-
-	Bank();
-	Bank(const BankElem& p1, const BankElem& p2 = defaultElem,
-	     const BankElem& p3 = defaultElem, const BankElem& p4 = defaultElem,
-	     const BankElem& p5 = defaultElem, const BankElem& p6 = defaultElem,
-	     const BankElem& p7 = defaultElem, const BankElem& p8 = defaultElem,
-	     const BankElem& p9 = defaultElem, const BankElem& p10 = defaultElem);
+	constexpr Bank(const BankElem* programs_)
+		: programs{programs_}
+		, size{countPrograms(programs_, programsPerBank)}
+	{}
 
-	const std::string getProgramName(int i);
-	float getProgramGain(int i);
+	const char* getProgramName(int i) const;
+	float getProgramGain(int i) const;
+	// returns a new instance of the algorithm in slot i, or nullptr if the slot is empty
+	NoisePlethoraPlugin* createProgram(int i) const;
 
-	int getSize();
+	constexpr int getSize() const {
+		return size;
+	}
 
 private:
 
-	std::array<BankElem, programsPerBank> programs;
+	// number of programs before the first empty slot
+	static constexpr int countPrograms(const BankElem* p, int n) {
+		return (n > 0 && p->name != nullptr) ? 1 + countPrograms(p + 1, n - 1) : 0;
+	}
 
+	const BankElem* programs;
+	int size;
 };
 
-Bank& getBankForIndex(int i);
+const Bank& getBankForIndex(int i);
+
+inline int getAlgorithmId(int bank, int program) {
+	return bank * programsPerBank + program;
+}
+
+// looks up an algorithm by name (e.g. when loading a patch), returns -1 if not found
+int findAlgorithmId(const std::string& name);
@@ -2,10 +2,8 @@
 
 #include <rack.hpp>
 #include <memory>
-#include <string> // string might not be allowed
-#include <functional>
-#include <map>
 
+#include "Banks.hpp"
 #include "../teensy/TeensyAudioReplacements.hpp"
 
 
@@ -33,6 +31,12 @@ public:
 		return int16_to_float_1v(blockBuffer.shift());
 	}
 
+	// discards any partially consumed block, so that a (pooled) instance that is
+	// switched back in starts from a freshly rendered block
+	void resetGraph() {
+		blockBuffer.clear();
+	}
+
 	virtual AudioStream& getStream() = 0;
 	virtual unsigned char getPort() = 0;
 
@@ -45,46 +49,29 @@ protected:
 };
 
 
-class MyFactory {
+// Holds one pre-constructed instance of every algorithm in the banks, indexed by algorithm ID.
+// Construct off the audio thread; switching algorithm is then a pointer swap, with no allocation or freeing.
+class AlgorithmPool {
 public:
-	static MyFactory* Instance() {
-		static MyFactory factory;
-		return &factory;
+	AlgorithmPool() {
+		for (int bank = 0; bank < numBanks; ++bank) {
+			for (int program = 0; program < getBankForIndex(bank).getSize(); ++program) {
+				instances[getAlgorithmId(bank, program)].reset(getBankForIndex(bank).createProgram(program));
+			}
+		}
 	}
 
-	std::shared_ptr<NoisePlethoraPlugin> Create(std::string name) {
-		NoisePlethoraPlugin* instance = nullptr;
+	AlgorithmPool(const AlgorithmPool&) = delete;
+	AlgorithmPool& operator=(const AlgorithmPool&) = delete;
 
-		// find name in the registry and call factory method.
-		auto it = factoryFunctionRegistry.find(name);
-		if (it != factoryFunctionRegistry.end()) {
-			instance = it->second();
-		}
-
-		// wrap instance in a shared ptr and return
-		if (instance != nullptr) {
-			return std::shared_ptr<NoisePlethoraPlugin>(instance);
-		}
-		else {
+	// returns nullptr if there is no algorithm with this ID
+	NoisePlethoraPlugin* get(int algorithmId) {
+		if (algorithmId < 0 || algorithmId >= numAlgorithms) {
 			return nullptr;
 		}
+		return instances[algorithmId].get();
 	}
 
-	void RegisterFactoryFunction(std::string name, std::function<NoisePlethoraPlugin*(void)> classFactoryFunction) {
-		// register the class factory function
-		factoryFunctionRegistry[name] = classFactoryFunction;
-	}
-
-	std::map<std::string, std::function<NoisePlethoraPlugin*(void)>> factoryFunctionRegistry;
-};
-
-template<class T> class Registrar {
-public:
-	Registrar(std::string className) {
-		// register the class factory function
-		MyFactory::Instance()->RegisterFactoryFunction(className,
-		    [](void) -> NoisePlethoraPlugin * { return new T();});
-	}
+private:
+	std::unique_ptr<NoisePlethoraPlugin> instances[numAlgorithms];
 };
-
-#define REGISTER_PLUGIN(NAME) static Registrar<NAME> NAME ##_reg(#NAME)
\ No newline at end of file
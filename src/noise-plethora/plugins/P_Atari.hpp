@@ -66,5 +66,3 @@ private:
 	//AudioConnection          patchCord3;
 
 };
-
-REGISTER_PLUGIN(Atari);
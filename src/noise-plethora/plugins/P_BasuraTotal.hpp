@@ -88,5 +88,3 @@ private:
 	// AudioConnection             patchCord1;
 	// unsigned long               lastClick;
 };
-
-REGISTER_PLUGIN(BasuraTotal);
\ No newline at end of file
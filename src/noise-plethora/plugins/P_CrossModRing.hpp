@@ -115,5 +115,3 @@ private:
 	// AudioConnection          patchCord10(multiply1, 0, multiply3, 0);
 
 };
-
-REGISTER_PLUGIN(CrossModRing);
@@ -244,5 +244,3 @@ private:
 	// AudioConnection          patchCord35;
 	// AudioConnection          patchCord36;
 };
-
-REGISTER_PLUGIN(PrimeCnoise);
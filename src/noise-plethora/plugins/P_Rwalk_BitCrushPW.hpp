@@ -254,5 +254,3 @@ private:
 	float x[9], y[9], vx[9], vy[9]; // number depends on waveforms declared
 
 };
-
-REGISTER_PLUGIN(Rwalk_BitCrushPW); // this is important, so that we can include the plugin in a bank
@@ -152,5 +152,3 @@ private:
 	float x[4], y[4], vx[4], vy[4]; // number depends on waveforms declared
 
 };
-
-REGISTER_PLUGIN(Rwalk_LFree); // this is important, so that we can include the plugin in a bank
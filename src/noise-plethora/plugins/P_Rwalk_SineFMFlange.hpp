@@ -195,5 +195,3 @@ private:
 	double mod_freq;
 
 };
-
-REGISTER_PLUGIN(Rwalk_SineFMFlange); // this is important, so that we can include the plugin in a bank
@@ -61,5 +61,3 @@ private:
 	//AudioConnection          patchCord3(freeverb1, 0, mixer1, 1);
 
 };
-
-REGISTER_PLUGIN(S_H);
@@ -60,5 +60,3 @@ private:
 	AudioFilterStateVariable filter1;        //xy=1062.2726001739502,460.8181266784668
 
 };
-
-REGISTER_PLUGIN(TeensyAlt);
@@ -80,6 +80,3 @@ private:
 	//AudioConnection          patchCord3;
 
 };
-
-
-REGISTER_PLUGIN(TestPlugin);
\ No newline at end of file
@@ -41,77 +41,56 @@ public:
 		L = 1800; // Size of box: maximum frequency
 		v_0 = 10; // speed: size of step in frequency units.
 
-		mixer1.gain(0, 1);
-		mixer1.gain(1, 1);
-		mixer1.gain(2, 1);
-		mixer1.gain(3, 1);
-		mixer2.gain(0, 1);
-		mixer2.gain(1, 1);
-		mixer2.gain(2, 1);
-		mixer2.gain(3, 1);
-		mixer3.gain(0, 1);
-		mixer3.gain(1, 1);
-		mixer3.gain(2, 1);
-		mixer3.gain(3, 1);
-		mixer4.gain(0, 1);
-		mixer4.gain(1, 1);
-		mixer4.gain(2, 1);
-		mixer4.gain(3, 1);
-		mixer5.gain(0, 1);
-		mixer5.gain(1, 1);
-		mixer5.gain(2, 1);
-		mixer5.gain(3, 1);
-
 		//   SINE
 		WaveformType masterWaveform = WAVEFORM_PULSE;
 
-		waveform1.pulseWidth(0.5);
-		waveform1.begin(1, 794, masterWaveform);
+		waveforms.pulseWidth(0, 0.5);
+		waveforms.begin(0, 1, 794, masterWaveform);
 
-		waveform2.pulseWidth(0.5);
-		waveform2.begin(1, 647, masterWaveform);
+		waveforms.pulseWidth(1, 0.5);
+		waveforms.begin(1, 1, 647, masterWaveform);
 
-		waveform3.pulseWidth(0.5);
-		waveform3.begin(1, 524, masterWaveform);
+		waveforms.pulseWidth(2, 0.5);
+		waveforms.begin(2, 1, 524, masterWaveform);
 
-		waveform4.pulseWidth(0.5);
-		waveform4.begin(1, 444, masterWaveform);
+		waveforms.pulseWidth(3, 0.5);
+		waveforms.begin(3, 1, 444, masterWaveform);
 
-		waveform5.pulseWidth(0.5);
-		waveform5.begin(1, 368, masterWaveform);
+		waveforms.pulseWidth(4, 0.5);
+		waveforms.begin(4, 1, 368, masterWaveform);
 
-		waveform6.pulseWidth(0.5);
-		waveform6.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(5, 0.5);
+		waveforms.begin(5, 1, 283, masterWaveform);
 
-		waveform7.pulseWidth(0.5);
-		waveform7.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(6, 0.5);
+		waveforms.begin(6, 1, 283, masterWaveform);
 
-		waveform8.pulseWidth(0.5);
-		waveform8.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(7, 0.5);
+		waveforms.begin(7, 1, 283, masterWaveform);
 
-		waveform9.pulseWidth(0.5);
-		waveform9.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(8, 0.5);
+		waveforms.begin(8, 1, 283, masterWaveform);
 
-		waveform10.pulseWidth(0.5);
-		waveform10.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(9, 0.5);
+		waveforms.begin(9, 1, 283, masterWaveform);
 
-		waveform11.pulseWidth(0.5);
-		waveform11.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(10, 0.5);
+		waveforms.begin(10, 1, 283, masterWaveform);
 
-		waveform12.pulseWidth(0.5);
-		waveform12.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(11, 0.5);
+		waveforms.begin(11, 1, 283, masterWaveform);
 
-		waveform13.pulseWidth(0.5);
-		waveform13.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(12, 0.5);
+		waveforms.begin(12, 1, 283, masterWaveform);
 
-		waveform14.pulseWidth(0.5);
-		waveform14.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(13, 0.5);
+		waveforms.begin(13, 1, 283, masterWaveform);
 
-		waveform15.pulseWidth(0.5);
-		waveform15.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(14, 0.5);
+		waveforms.begin(14, 1, 283, masterWaveform);
 
-		waveform16.pulseWidth(0.5);
-		waveform16.begin(1, 283, masterWaveform);
+		waveforms.pulseWidth(15, 0.5);
+		waveforms.begin(15, 1, 283, masterWaveform);
 
 		// random walk initial conditions
 		for (int i = 0; i < 16; i++) {
@@ -128,8 +107,6 @@ public:
 
 	void process(float k1, float k2) override {
 
-
-
 		float knob_1 = k1;
 		float knob_2 = k2;
 		float pw;
@@ -172,74 +149,52 @@ public:
 
 		}
 
-		waveform1.pulseWidth(pw);
-		waveform2.pulseWidth(pw);
-		waveform3.pulseWidth(pw);
-		waveform4.pulseWidth(pw);
-		waveform5.pulseWidth(pw);
-		waveform6.pulseWidth(pw);
-		waveform7.pulseWidth(pw);
-		waveform8.pulseWidth(pw);
-
-		waveform9.pulseWidth(pw);
-		waveform10.pulseWidth(pw);
-		waveform11.pulseWidth(pw);
-		waveform12.pulseWidth(pw);
-		waveform13.pulseWidth(pw);
-		waveform14.pulseWidth(pw);
-		waveform15.pulseWidth(pw);
-		waveform16.pulseWidth(pw);
-
-		waveform1.frequency(x[0]);
-		waveform2.frequency(x[1]);
-		waveform3.frequency(x[2]);
-		waveform4.frequency(x[3]);
-		waveform5.frequency(x[4]);
-		waveform6.frequency(x[5]);
-		waveform7.frequency(x[6]);
-		waveform8.frequency(x[7]);
-		waveform9.frequency(x[8]);
-		waveform10.frequency(x[9]);
-		waveform11.frequency(x[10]);
-		waveform12.frequency(x[11]);
-		waveform13.frequency(x[12]);
-		waveform14.frequency(x[13]);
-		waveform15.frequency(x[14]);
-		waveform16.frequency(x[15]);
-
+		waveforms.pulseWidth(0, pw);
+		waveforms.pulseWidth(1, pw);
+		waveforms.pulseWidth(2, pw);
+		waveforms.pulseWidth(3, pw);
+		waveforms.pulseWidth(4, pw);
+		waveforms.pulseWidth(5, pw);
+		waveforms.pulseWidth(6, pw);
+		waveforms.pulseWidth(7, pw);
+
+		waveforms.pulseWidth(8, pw);
+		waveforms.pulseWidth(9, pw);
+		waveforms.pulseWidth(10, pw);
+		waveforms.pulseWidth(11, pw);
+		waveforms.pulseWidth(12, pw);
+		waveforms.pulseWidth(13, pw);
+		waveforms.pulseWidth(14, pw);
+		waveforms.pulseWidth(15, pw);
+
+		waveforms.frequency(0, x[0]);
+		waveforms.frequency(1, x[1]);
+		waveforms.frequency(2, x[2]);
+		waveforms.frequency(3, x[3]);
+		waveforms.frequency(4, x[4]);
+		waveforms.frequency(5, x[5]);
+		waveforms.frequency(6, x[6]);
+		waveforms.frequency(7, x[7]);
+		waveforms.frequency(8, x[8]);
+		waveforms.frequency(9, x[9]);
+		waveforms.frequency(10, x[10]);
+		waveforms.frequency(11, x[11]);
+		waveforms.frequency(12, x[12]);
+		waveforms.frequency(13, x[13]);
+		waveforms.frequency(14, x[14]);
+		waveforms.frequency(15, x[15]);
 
 	}
 
 	void processGraphAsBlock(TeensyBuffer& blockBuffer) override {
 
-		waveform1.update(&waveformBlock[0]);
-		waveform2.update(&waveformBlock[1]);
-		waveform3.update(&waveformBlock[2]);
-		waveform4.update(&waveformBlock[3]);
-		waveform5.update(&waveformBlock[4]);
-		waveform6.update(&waveformBlock[5]);
-		waveform7.update(&waveformBlock[6]);
-		waveform8.update(&waveformBlock[7]);
-		waveform9.update(&waveformBlock[8]);
-		waveform10.update(&waveformBlock[9]);
-		waveform11.update(&waveformBlock[10]);
-		waveform12.update(&waveformBlock[11]);
-		waveform13.update(&waveformBlock[12]);
-		waveform14.update(&waveformBlock[13]);
-		waveform15.update(&waveformBlock[14]);
-		waveform16.update(&waveformBlock[15]);
-
-		mixer1.update(&waveformBlock[0], &waveformBlock[1], &waveformBlock[2], &waveformBlock[3], &mixBlock[0]);
-		mixer2.update(&waveformBlock[4], &waveformBlock[5], &waveformBlock[6], &waveformBlock[7], &mixBlock[1]);
-		mixer3.update(&waveformBlock[8], &waveformBlock[9], &waveformBlock[10], &waveformBlock[11], &mixBlock[2]);
-		mixer4.update(&waveformBlock[12], &waveformBlock[13], &waveformBlock[14], &waveformBlock[15], &mixBlock[3]);
-
-		mixer5.update(&mixBlock[0], &mixBlock[1], &mixBlock[2], &mixBlock[3], &mixBlock[4]);
-		blockBuffer.pushBuffer(mixBlock[4].data, AUDIO_BLOCK_SAMPLES);
+		// all waveforms summed (replaces waveforms 1-16 and mixers 1-5 in the original graph)
+		waveforms.update(nullptr, nullptr, &mixBlock);
+		blockBuffer.pushBuffer(mixBlock.data, AUDIO_BLOCK_SAMPLES);
 	}
 
 	AudioStream& getStream() override {
-		return mixer5;
+		return waveforms;
 	}
 	unsigned char getPort() override {
 		return 0;
@@ -247,31 +202,11 @@ public:
 
 private:
 
-	audio_block_t waveformBlock[16], mixBlock[5];
+	audio_block_t mixBlock;
 
 	/* will be filled in */
 	// GUItool: begin automatically generated code
-	AudioSynthWaveform       waveform12; //xy=517.75,725.75
-	AudioSynthWaveform       waveform16; //xy=517.75,874.75
-	AudioSynthWaveform       waveform11; //xy=518.75,689.75
-	AudioSynthWaveform       waveform8; //xy=519.75,577.75
-	AudioSynthWaveform       waveform15; //xy=518.75,838.75
-	AudioSynthWaveform       waveform9; //xy=519.75,614.75
-	AudioSynthWaveform       waveform10; //xy=519.75,652.75
-	AudioSynthWaveform       waveform13; //xy=519.75,763.75
-	AudioSynthWaveform       waveform7; //xy=520.75,541.75
-	AudioSynthWaveform       waveform14; //xy=519.75,801.75
-	AudioSynthWaveform       waveform4;      //xy=521.75,427.75
-	AudioSynthWaveform       waveform5; //xy=521.75,466.75
-	AudioSynthWaveform       waveform6; //xy=521.75,504.75
-	AudioSynthWaveform       waveform3;      //xy=522.75,391.75
-	AudioSynthWaveform       waveform1;      //xy=523.75,316.75
-	AudioSynthWaveform       waveform2;      //xy=523.75,354.75
-	AudioMixer4              mixer2; //xy=713.75,528.75
-	AudioMixer4              mixer1;         //xy=714.75,377.75
-	AudioMixer4              mixer3; //xy=716.75,664.75
-	AudioMixer4              mixer4; //xy=717.75,792.75
-	AudioMixer4              mixer5; //xy=961.75,589.75
+	AudioSynthWaveformBank<16> waveforms;
 	//AudioOutputI2S           i2s1;           //xy=1227.75,604.75
 	// AudioConnection          patchCord1;
 	// AudioConnection          patchCord2;
@@ -301,5 +236,3 @@ private:
 	float x[16], y[16], vx[16], vy[16]; // number depends on waveforms declared
 
 };
-
-REGISTER_PLUGIN(WalkingFilomena); // this is important, so that we can include the plugin in a bank
@@ -45,5 +45,3 @@ private:
 	AudioSynthNoiseWhite noise1;
 
 };
-
-REGISTER_PLUGIN(WhiteNoise);
@@ -76,5 +76,3 @@ private:
 	// AudioConnection          patchCord3;
 	// AudioConnection          patchCord4;
 };
-
-REGISTER_PLUGIN(XModRingSine); // this is important, so that we can include the plugin in a bank
@@ -128,10 +128,3 @@ private:
 
 
 };
-
-
-
-
-
-
-REGISTER_PLUGIN(arrayOnTheRocks); // this is important, so that we can include the plugin in a bank
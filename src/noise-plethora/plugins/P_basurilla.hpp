@@ -104,5 +104,3 @@ private:
 	//
 
 };
-
-REGISTER_PLUGIN(basurilla);
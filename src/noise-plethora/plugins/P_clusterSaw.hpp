@@ -35,45 +35,24 @@ public:
 	clusterSaw& operator=(const clusterSaw&) = delete;
 
 	void init() override {
-		mixer1.gain(0, 1);
-		mixer1.gain(1, 1);
-		mixer1.gain(2, 1);
-		mixer1.gain(3, 1);
-		mixer2.gain(0, 1);
-		mixer2.gain(1, 1);
-		mixer2.gain(2, 1);
-		mixer2.gain(3, 1);
-		mixer3.gain(0, 1);
-		mixer3.gain(1, 1);
-		mixer3.gain(2, 1);
-		mixer3.gain(3, 1);
-		mixer4.gain(0, 1);
-		mixer4.gain(1, 1);
-		mixer4.gain(2, 1);
-		mixer4.gain(3, 1);
-		mixer5.gain(0, 1);
-		mixer5.gain(1, 1);
-		mixer5.gain(2, 1);
-		mixer5.gain(3, 1);
-
 		WaveformType masterWaveform = WAVEFORM_SAWTOOTH;
 		float masterVolume = 0.25;
-		waveform1.begin(masterVolume, 0, masterWaveform);
-		waveform2.begin(masterVolume, 0, masterWaveform);
-		waveform3.begin(masterVolume, 0, masterWaveform);
-		waveform4.begin(masterVolume, 0, masterWaveform);
-		waveform5.begin(masterVolume, 0, masterWaveform);
-		waveform6.begin(masterVolume, 0, masterWaveform);
-		waveform7.begin(masterVolume, 0, masterWaveform);
-		waveform8.begin(masterVolume, 0, masterWaveform);
-		waveform9.begin(masterVolume, 0, masterWaveform);
-		waveform10.begin(masterVolume, 0, masterWaveform);
-		waveform11.begin(masterVolume, 0, masterWaveform);
-		waveform12.begin(masterVolume, 0, masterWaveform);
-		waveform13.begin(masterVolume, 0, masterWaveform);
-		waveform14.begin(masterVolume, 0, masterWaveform);
-		waveform15.begin(masterVolume, 0, masterWaveform);
-		waveform16.begin(masterVolume, 0, masterWaveform);
+		waveforms.begin(0, masterVolume, 0, masterWaveform);
+		waveforms.begin(1, masterVolume, 0, masterWaveform);
+		waveforms.begin(2, masterVolume, 0, masterWaveform);
+		waveforms.begin(3, masterVolume, 0, masterWaveform);
+		waveforms.begin(4, masterVolume, 0, masterWaveform);
+		waveforms.begin(5, masterVolume, 0, masterWaveform);
+		waveforms.begin(6, masterVolume, 0, masterWaveform);
+		waveforms.begin(7, masterVolume, 0, masterWaveform);
+		waveforms.begin(8, masterVolume, 0, masterWaveform);
+		waveforms.begin(9, masterVolume, 0, masterWaveform);
+		waveforms.begin(10, masterVolume, 0, masterWaveform);
+		waveforms.begin(11, masterVolume, 0, masterWaveform);
+		waveforms.begin(12, masterVolume, 0, masterWaveform);
+		waveforms.begin(13, masterVolume, 0, masterWaveform);
+		waveforms.begin(14, masterVolume, 0, masterWaveform);
+		waveforms.begin(15, masterVolume, 0, masterWaveform);
 
 	}
 
@@ -99,58 +78,33 @@ public:
 		float f14 = f13 * multFactor;
 		float f15 = f14 * multFactor;
 		float f16 = f15 * multFactor;
-		waveform1.frequency(f1);
-		waveform2.frequency(f2);
-		waveform3.frequency(f3);
-		waveform4.frequency(f4);
-		waveform5.frequency(f5);
-		waveform6.frequency(f6);
-		waveform7.frequency(f7);
-		waveform8.frequency(f8);
-		waveform9.frequency(f9);
-		waveform10.frequency(f10);
-		waveform11.frequency(f11);
-		waveform12.frequency(f12);
-		waveform13.frequency(f13);
-		waveform14.frequency(f14);
-		waveform15.frequency(f15);
-		waveform16.frequency(f16);
+		waveforms.frequency(0, f1);
+		waveforms.frequency(1, f2);
+		waveforms.frequency(2, f3);
+		waveforms.frequency(3, f4);
+		waveforms.frequency(4, f5);
+		waveforms.frequency(5, f6);
+		waveforms.frequency(6, f7);
+		waveforms.frequency(7, f8);
+		waveforms.frequency(8, f9);
+		waveforms.frequency(9, f10);
+		waveforms.frequency(10, f11);
+		waveforms.frequency(11, f12);
+		waveforms.frequency(12, f13);
+		waveforms.frequency(13, f14);
+		waveforms.frequency(14, f15);
+		waveforms.frequency(15, f16);
 	}
 
 	void processGraphAsBlock(TeensyBuffer& blockBuffer) override {
 
-		// update waveforms
-		// FM from single noise source
-		waveform1.update(nullptr, nullptr, &waveformOut[0]);
-		waveform2.update(nullptr, nullptr, &waveformOut[1]);
-		waveform3.update(nullptr, nullptr, &waveformOut[2]);
-		waveform4.update(nullptr, nullptr, &waveformOut[3]);
-		waveform5.update(nullptr, nullptr, &waveformOut[4]);
-		waveform6.update(nullptr, nullptr, &waveformOut[5]);
-		waveform7.update(nullptr, nullptr, &waveformOut[6]);
-		waveform8.update(nullptr, nullptr, &waveformOut[7]);
-		waveform9.update(nullptr, nullptr, &waveformOut[8]);
-		waveform10.update(nullptr, nullptr, &waveformOut[9]);
-		waveform11.update(nullptr, nullptr, &waveformOut[10]);
-		waveform12.update(nullptr, nullptr, &waveformOut[11]);
-		waveform13.update(nullptr, nullptr, &waveformOut[12]);
-		waveform14.update(nullptr, nullptr, &waveformOut[13]);
-		waveform15.update(nullptr, nullptr, &waveformOut[14]);
-		waveform16.update(nullptr, nullptr, &waveformOut[15]);
-
-		// update mixers
-		mixer1.update(&waveformOut[0], &waveformOut[1], &waveformOut[2], &waveformOut[3], &mixerOut[0]);
-		mixer2.update(&waveformOut[4], &waveformOut[5], &waveformOut[6], &waveformOut[7], &mixerOut[1]);
-		mixer3.update(&waveformOut[8], &waveformOut[9], &waveformOut[10], &waveformOut[11], &mixerOut[2]);
-		mixer4.update(&waveformOut[12], &waveformOut[13], &waveformOut[14], &waveformOut[15], &mixerOut[3]);
-		// mixer of mixers
-		mixer5.update(&mixerOut[0], &mixerOut[1], &mixerOut[2], &mixerOut[3], &mixerOut[4]);
-
-		blockBuffer.pushBuffer(mixerOut[4].data, AUDIO_BLOCK_SAMPLES);
+		// render and sum all waveforms (replaces waveforms 1-16 and mixers 1-5 in the original graph)
+		waveforms.update(nullptr, nullptr, &waveformsOut);
+		blockBuffer.pushBuffer(waveformsOut.data, AUDIO_BLOCK_SAMPLES);
 	}
 
 	AudioStream& getStream() override {
-		return mixer5;
+		return waveforms;
 	}
 	unsigned char getPort() override {
 		return 0;
@@ -158,29 +112,9 @@ public:
 
 private:
 
-	audio_block_t waveformOut[16] = {}, mixerOut[5] = {};
+	audio_block_t waveformsOut = {};
 
-	AudioSynthWaveformModulated waveform16;     //xy=360.00000381469727,1486.0000076293945
-	AudioSynthWaveformModulated waveform14;     //xy=362.00000381469727,1381.0000076293945
-	AudioSynthWaveformModulated waveform15;     //xy=362.00000381469727,1426.0000076293945
-	AudioSynthWaveformModulated waveform13;     //xy=363.00000381469727,1339.0000076293945
-	AudioSynthWaveformModulated waveform8;      //xy=370.00000381469727,1066.0000076293945
-	AudioSynthWaveformModulated waveform6;      //xy=372.00000381469727,961.0000076293945
-	AudioSynthWaveformModulated waveform7;      //xy=372.00000381469727,1006.0000076293945
-	AudioSynthWaveformModulated waveform12;     //xy=371.00000381469727,1277.0000076293945
-	AudioSynthWaveformModulated waveform5;      //xy=373.00000381469727,919.0000076293945
-	AudioSynthWaveformModulated waveform10;     //xy=373.00000381469727,1172.0000076293945
-	AudioSynthWaveformModulated waveform11;     //xy=373.00000381469727,1217.0000076293945
-	AudioSynthWaveformModulated waveform9;      //xy=374.00000381469727,1130.0000076293945
-	AudioSynthWaveformModulated waveform4;      //xy=378.00000381469727,851.0000076293945
-	AudioSynthWaveformModulated waveform2;      //xy=380.00000381469727,746.0000076293945
-	AudioSynthWaveformModulated waveform3;      //xy=380.00000381469727,791.0000076293945
-	AudioSynthWaveformModulated waveform1;      //xy=381.00000381469727,703.0000076293945
-	AudioMixer4              mixer4;         //xy=546.0000038146973,1408.0000381469727
-	AudioMixer4              mixer2;         //xy=554.9999923706055,984.0000381469727
-	AudioMixer4              mixer1;         //xy=556.9999885559082,771.0000076293945
-	AudioMixer4              mixer3;         //xy=557.0000114440918,1196.0000228881836
-	AudioMixer4              mixer5;         //xy=755.0000267028809,1082.9999923706055
+	AudioSynthWaveformBank<16> waveforms;
 	// AudioConnection          patchCord18;
 	// AudioConnection          patchCord19;
 	// AudioConnection          patchCord20;
@@ -202,5 +136,3 @@ private:
 	// AudioConnection          patchCord36;
 	// AudioConnection          patchCord37;
 };
-
-REGISTER_PLUGIN(clusterSaw);
@@ -131,5 +131,3 @@ private:
 	// AudioConnection          patchCord13;
 	// AudioConnection          patchCord14;
 };
-
-REGISTER_PLUGIN(crCluster2);
@@ -142,5 +142,3 @@ private:
 	// AudioConnection          patchCord12;
 
 };
-
-REGISTER_PLUGIN(existencelsPain); // this is important, so that we can include the plugin in a bank
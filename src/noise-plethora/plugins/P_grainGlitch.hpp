@@ -87,5 +87,3 @@ private:
 	audio_block_t waveformMod1Out;
 	audio_block_t combine1Out;
 };
-
-REGISTER_PLUGIN(grainGlitch);
@@ -74,5 +74,3 @@ private:
 
 	audio_block_t granularOut, waveformMod1Out;
 };
-
-REGISTER_PLUGIN(grainGlitchII);
@@ -70,5 +70,3 @@ private:
 	audio_block_t granularOut;
 	audio_block_t waveformMod1Previous;
 };
-
-REGISTER_PLUGIN(grainGlitchIII);
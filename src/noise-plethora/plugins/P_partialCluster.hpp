@@ -52,46 +52,25 @@ public:
 	partialCluster& operator=(const partialCluster&) = delete;
 
 	void init() override {
-		mixer1.gain(0, 1);
-		mixer1.gain(1, 1);
-		mixer1.gain(2, 1);
-		mixer1.gain(3, 1);
-		mixer2.gain(0, 1);
-		mixer2.gain(1, 1);
-		mixer2.gain(2, 1);
-		mixer2.gain(3, 1);
-		mixer3.gain(0, 1);
-		mixer3.gain(1, 1);
-		mixer3.gain(2, 1);
-		mixer3.gain(3, 1);
-		mixer4.gain(0, 1);
-		mixer4.gain(1, 1);
-		mixer4.gain(2, 1);
-		mixer4.gain(3, 1);
-		mixer5.gain(0, 1);
-		mixer5.gain(1, 1);
-		mixer5.gain(2, 1);
-		mixer5.gain(3, 1);
-
 		int masterWaveform = WAVEFORM_SAWTOOTH;
 		float masterVolume = 0.25;
 
-		waveform1.begin(masterVolume, 794, masterWaveform);
-		waveform2.begin(masterVolume, 647, masterWaveform);
-		waveform3.begin(masterVolume, 524, masterWaveform);
-		waveform4.begin(masterVolume, 444, masterWaveform);
-		waveform5.begin(masterVolume, 368, masterWaveform);
-		waveform6.begin(masterVolume, 283, masterWaveform);
-		waveform7.begin(masterVolume, 283, masterWaveform);
-		waveform8.begin(masterVolume, 283, masterWaveform);
-		waveform9.begin(masterVolume, 283, masterWaveform);
-		waveform10.begin(masterVolume, 283, masterWaveform);
-		waveform11.begin(masterVolume, 283, masterWaveform);
-		waveform12.begin(masterVolume, 283, masterWaveform);
-		waveform13.begin(masterVolume, 283, masterWaveform);
-		waveform14.begin(masterVolume, 283, masterWaveform);
-		waveform15.begin(masterVolume, 283, masterWaveform);
-		waveform16.begin(masterVolume, 283, masterWaveform);
+		waveforms.begin(0, masterVolume, 794, masterWaveform);
+		waveforms.begin(1, masterVolume, 647, masterWaveform);
+		waveforms.begin(2, masterVolume, 524, masterWaveform);
+		waveforms.begin(3, masterVolume, 444, masterWaveform);
+		waveforms.begin(4, masterVolume, 368, masterWaveform);
+		waveforms.begin(5, masterVolume, 283, masterWaveform);
+		waveforms.begin(6, masterVolume, 283, masterWaveform);
+		waveforms.begin(7, masterVolume, 283, masterWaveform);
+		waveforms.begin(8, masterVolume, 283, masterWaveform);
+		waveforms.begin(9, masterVolume, 283, masterWaveform);
+		waveforms.begin(10, masterVolume, 283, masterWaveform);
+		waveforms.begin(11, masterVolume, 283, masterWaveform);
+		waveforms.begin(12, masterVolume, 283, masterWaveform);
+		waveforms.begin(13, masterVolume, 283, masterWaveform);
+		waveforms.begin(14, masterVolume, 283, masterWaveform);
+		waveforms.begin(15, masterVolume, 283, masterWaveform);
 
 	}
 
@@ -122,23 +101,22 @@ public:
 		float f15 = f14 * spread;
 		float f16 = f15 * spread;
 
-
-		waveform1.frequency(fundamental);
-		waveform2.frequency(f2 * fundamental);
-		waveform3.frequency(f3 * fundamental);
-		waveform4.frequency(f4 * fundamental);
-		waveform5.frequency(f5 * fundamental);
-		waveform6.frequency(f6 * fundamental);
-		waveform7.frequency(f7 * fundamental);
-		waveform8.frequency(f8 * fundamental);
-		waveform9.frequency(f9 * fundamental);
-		waveform10.frequency(f10 * fundamental);
-		waveform11.frequency(f11 * fundamental);
-		waveform12.frequency(f12 * fundamental);
-		waveform13.frequency(f13 * fundamental);
-		waveform14.frequency(f14 * fundamental);
-		waveform15.frequency(f15 * fundamental);
-		waveform16.frequency(f16 * fundamental);
+		waveforms.frequency(0, fundamental);
+		waveforms.frequency(1, f2 * fundamental);
+		waveforms.frequency(2, f3 * fundamental);
+		waveforms.frequency(3, f4 * fundamental);
+		waveforms.frequency(4, f5 * fundamental);
+		waveforms.frequency(5, f6 * fundamental);
+		waveforms.frequency(6, f7 * fundamental);
+		waveforms.frequency(7, f8 * fundamental);
+		waveforms.frequency(8, f9 * fundamental);
+		waveforms.frequency(9, f10 * fundamental);
+		waveforms.frequency(10, f11 * fundamental);
+		waveforms.frequency(11, f12 * fundamental);
+		waveforms.frequency(12, f13 * fundamental);
+		waveforms.frequency(13, f14 * fundamental);
+		waveforms.frequency(14, f15 * fundamental);
+		waveforms.frequency(15, f16 * fundamental);
 
 	}
 
@@ -146,36 +124,13 @@ public:
 
 		noise1.update(&noiseOut);
 
-		// FM from single noise source
-		waveform1.update(&noiseOut, nullptr, &waveformOut[0]);
-		waveform2.update(&noiseOut, nullptr, &waveformOut[1]);
-		waveform3.update(&noiseOut, nullptr, &waveformOut[2]);
-		waveform4.update(&noiseOut, nullptr, &waveformOut[3]);
-		waveform5.update(&noiseOut, nullptr, &waveformOut[4]);
-		waveform6.update(&noiseOut, nullptr, &waveformOut[5]);
-		waveform7.update(&noiseOut, nullptr, &waveformOut[6]);
-		waveform8.update(&noiseOut, nullptr, &waveformOut[7]);
-		waveform9.update(&noiseOut, nullptr, &waveformOut[8]);
-		waveform10.update(&noiseOut, nullptr, &waveformOut[9]);
-		waveform11.update(&noiseOut, nullptr, &waveformOut[10]);
-		waveform12.update(&noiseOut, nullptr, &waveformOut[11]);
-		waveform13.update(&noiseOut, nullptr, &waveformOut[12]);
-		waveform14.update(&noiseOut, nullptr, &waveformOut[13]);
-		waveform15.update(&noiseOut, nullptr, &waveformOut[14]);
-		waveform16.update(&noiseOut, nullptr, &waveformOut[15]);
-
-		mixer1.update(&waveformOut[0], &waveformOut[1], &waveformOut[2], &waveformOut[3], &mixerOut[0]);
-		mixer2.update(&waveformOut[4], &waveformOut[5], &waveformOut[6], &waveformOut[7], &mixerOut[1]);
-		mixer3.update(&waveformOut[8], &waveformOut[9], &waveformOut[10], &waveformOut[11], &mixerOut[2]);
-		mixer4.update(&waveformOut[12], &waveformOut[13], &waveformOut[14], &waveformOut[15], &mixerOut[3]);
-
-		mixer5.update(&mixerOut[0], &mixerOut[1], &mixerOut[2], &mixerOut[3], &mixerOut[4]);
-
-		blockBuffer.pushBuffer(mixerOut[4].data, AUDIO_BLOCK_SAMPLES);
+		// FM from single noise source, all waveforms summed (replaces waveforms 1-16 and mixers 1-5 in the original graph)
+		waveforms.update(&noiseOut, nullptr, &waveformsOut);
+		blockBuffer.pushBuffer(waveformsOut.data, AUDIO_BLOCK_SAMPLES);
 	}
 
 	AudioStream& getStream() override {
-		return mixer5;
+		return waveforms;
 	}
 	unsigned char getPort() override {
 		return 0;
@@ -183,30 +138,10 @@ public:
 
 private:
 
-	audio_block_t noiseOut, waveformOut[16] = {}, mixerOut[5] = {};
+	audio_block_t noiseOut, waveformsOut = {};
 
 	AudioSynthNoiseWhite     noise1;         //xy=296.75,791.75
-	AudioSynthWaveformModulated waveform16; //xy=581.75,1167.5
-	AudioSynthWaveformModulated waveform14; //xy=583.75,1062.5
-	AudioSynthWaveformModulated waveform15; //xy=583.75,1107.5
-	AudioSynthWaveformModulated waveform13; //xy=584.75,1020
-	AudioSynthWaveformModulated waveform8; //xy=591.75,747.5
-	AudioSynthWaveformModulated waveform6; //xy=593.75,642.5
-	AudioSynthWaveformModulated waveform7; //xy=593.75,687.5
-	AudioSynthWaveformModulated waveform12; //xy=592.75,958.5
-	AudioSynthWaveformModulated waveform5; //xy=594.75,600
-	AudioSynthWaveformModulated waveform10; //xy=594.75,853.5
-	AudioSynthWaveformModulated waveform11; //xy=594.75,898.5
-	AudioSynthWaveformModulated waveform9; //xy=595.75,811
-	AudioSynthWaveformModulated waveform4; //xy=599.75,532.25
-	AudioSynthWaveformModulated waveform2; //xy=601.75,427.25
-	AudioSynthWaveformModulated waveform3; //xy=601.75,472.25
-	AudioSynthWaveformModulated waveform1;   //xy=602.75,384.75
-	AudioMixer4              mixer4; //xy=801.75,1111.25
-	AudioMixer4              mixer3; //xy=812.75,902.25
-	AudioMixer4              mixer2; //xy=818.75,691.25
-	AudioMixer4              mixer1;         //xy=819.75,476
-	AudioMixer4              mixer5;         //xy=1066.75,688
+	AudioSynthWaveformBank<16> waveforms;
 	// AudioConnection          patchCord1;
 	// AudioConnection          patchCord2;
 	// AudioConnection          patchCord3;
@@ -245,5 +180,3 @@ private:
 	// AudioConnection          patchCord36;
 
 };
-
-REGISTER_PLUGIN(partialCluster);
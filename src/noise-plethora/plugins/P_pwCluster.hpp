@@ -34,29 +34,15 @@ public:
 	pwCluster& operator=(const pwCluster&) = delete;
 
 	void init() override {
-
-		mixer1.gain(0, 1);
-		mixer1.gain(1, 1);
-		mixer1.gain(2, 1);
-		mixer1.gain(3, 1);
-		mixer2.gain(0, 1);
-		mixer2.gain(1, 1);
-		mixer2.gain(2, 1);
-		mixer2.gain(3, 1);
-		mixer5.gain(0, 1);
-		mixer5.gain(1, 1);
-		mixer5.gain(2, 1);
-		mixer5.gain(3, 1);
-
 		int masterWaveform = WAVEFORM_PULSE;
 		float masterVolume = 0.7;
 
-		waveform1.begin(masterVolume, 794, masterWaveform);
-		waveform2.begin(masterVolume, 647, masterWaveform);
-		waveform3.begin(masterVolume, 524, masterWaveform);
-		waveform4.begin(masterVolume, 444, masterWaveform);
-		waveform5.begin(masterVolume, 368, masterWaveform);
-		waveform6.begin(masterVolume, 283, masterWaveform);
+		waveforms.begin(0, masterVolume, 794, masterWaveform);
+		waveforms.begin(1, masterVolume, 647, masterWaveform);
+		waveforms.begin(2, masterVolume, 524, masterWaveform);
+		waveforms.begin(3, masterVolume, 444, masterWaveform);
+		waveforms.begin(4, masterVolume, 368, masterWaveform);
+		waveforms.begin(5, masterVolume, 283, masterWaveform);
 	}
 
 	void process(float k1, float k2) override {
@@ -72,52 +58,34 @@ public:
 		float f6 = f5 * 1.3;
 		dc1.amplitude(1 - (knob_2 * 0.97));
 
-		waveform1.frequency(f1);
-		waveform2.frequency(f2);
-		waveform3.frequency(f3);
-		waveform4.frequency(f4);
-		waveform5.frequency(f5);
-		waveform6.frequency(f6);
+		waveforms.frequency(0, f1);
+		waveforms.frequency(1, f2);
+		waveforms.frequency(2, f3);
+		waveforms.frequency(3, f4);
+		waveforms.frequency(4, f5);
+		waveforms.frequency(5, f6);
 	}
 
 	void processGraphAsBlock(TeensyBuffer& blockBuffer) override {
 		dc1.update(&dcOut);
 
-		// pulsewidth from dc1 for the 6 oscillators
-		waveform1.update(nullptr, &dcOut, &waveformOut[0]);
-		waveform2.update(nullptr, &dcOut, &waveformOut[1]);
-		waveform3.update(nullptr, &dcOut, &waveformOut[2]);
-		waveform4.update(nullptr, &dcOut, &waveformOut[3]);
-		waveform5.update(nullptr, &dcOut, &waveformOut[4]);
-		waveform6.update(nullptr, &dcOut, &waveformOut[5]);
-
-		mixer1.update(&waveformOut[0], &waveformOut[1], &waveformOut[2], &waveformOut[3], &mixerOut[0]);
-		mixer2.update(&waveformOut[4], &waveformOut[5], nullptr, nullptr, &mixerOut[1]);
-		mixer5.update(&mixerOut[0], &mixerOut[1], nullptr, nullptr, &mixerOut[2]);
-
-		blockBuffer.pushBuffer(mixerOut[2].data, AUDIO_BLOCK_SAMPLES);
+		// pulsewidth from dc1 for the 6 oscillators, summed (replaces waveforms 1-6 and mixers 1, 2 and 5 in the original graph)
+		waveforms.update(nullptr, &dcOut, &waveformsOut);
+		blockBuffer.pushBuffer(waveformsOut.data, AUDIO_BLOCK_SAMPLES);
 	}
 
 	AudioStream& getStream() override {
-		return mixer5;
+		return waveforms;
 	}
 	unsigned char getPort() override {
 		return 0;
 	}
 
 private:
-	audio_block_t dcOut, waveformOut[6] = {}, mixerOut[3] = {};
+	audio_block_t dcOut, waveformsOut = {};
 
 	AudioSynthWaveformDc     dc1;            //xy=305.8888854980469,1069.1111450195312
-	AudioSynthWaveformModulated waveform6;      //xy=482.8888854980469,800.1111450195312
-	AudioSynthWaveformModulated waveform5;      //xy=483.8888854980469,758.1111450195312
-	AudioSynthWaveformModulated waveform4;      //xy=488.8888854980469,690.1111450195312
-	AudioSynthWaveformModulated waveform2;      //xy=490.8888854980469,585.1111450195312
-	AudioSynthWaveformModulated waveform3;      //xy=490.8888854980469,630.1111450195312
-	AudioSynthWaveformModulated waveform1;      //xy=491.8888854980469,542.1111450195312
-	AudioMixer4              mixer1;         //xy=708.8888854980469,634.1111450195312
-	AudioMixer4              mixer2;         //xy=719.8888854980469,789.1111450195312
-	AudioMixer4              mixer5;         //xy=955.8888854980469,846.1111450195312
+	AudioSynthWaveformBank<6> waveforms;
 
 	// AudioConnection          patchCord1;
 	// AudioConnection          patchCord2;
@@ -135,5 +103,3 @@ private:
 	// AudioConnection          patchCord14;
 
 };
-
-REGISTER_PLUGIN(pwCluster);
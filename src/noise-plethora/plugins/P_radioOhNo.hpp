@@ -95,5 +95,3 @@ private:
 	// AudioConnection          patchCord9;
 	// AudioConnection          patchCord10;
 };
-
-REGISTER_PLUGIN(radioOhNo);
@@ -91,5 +91,3 @@ private:
 	// AudioConnection          patchCord5;
 
 };
-
-REGISTER_PLUGIN(resonoise); // this is important, so that we can include the plugin in a bank
@@ -70,5 +70,3 @@ private:
 
 
 };
-
-REGISTER_PLUGIN(satanWorkout); // this is important, so that we can include the plugin in a bank
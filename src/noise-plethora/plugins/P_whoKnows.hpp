@@ -144,5 +144,3 @@ private:
 	// AudioConnection          patchCord12;
 
 };
-
-REGISTER_PLUGIN(whoKnows); // this is important, so that we can include the plugin in a bank
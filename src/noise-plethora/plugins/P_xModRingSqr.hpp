@@ -67,5 +67,3 @@ private:
 	// AudioConnection          patchCord4;
 
 };
-
-REGISTER_PLUGIN(xModRingSqr);
@@ -68,10 +68,14 @@ public:
 		return program.setValue(p, getBankForIndex(getBank()).getSize());
 	}
 
-	const std::string getCurrentProgramName() {
+	const char* getCurrentProgramName() {
 		return getBankForIndex(getBank()).getProgramName(getProgram());
 	}
 
+	int getCurrentProgramId() {
+		return getAlgorithmId(getBank(), getProgram());
+	}
+
 	float getCurrentProgramGain() {
 		return getBankForIndex(getBank()).getProgramGain(getProgram());
 	}
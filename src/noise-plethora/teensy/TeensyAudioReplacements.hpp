@@ -16,6 +16,7 @@
 #include "synth_dc.hpp"
 #include "synth_sine.hpp"
 #include "synth_waveform.hpp"
+#include "synth_waveform_bank.hpp"
 #include "synth_whitenoise.hpp"
 #include "synth_pinknoise.hpp"
 #include "synth_pwm.hpp"
\ No newline at end of file
@@ -35,6 +35,22 @@ typedef struct audio_block_struct {
 	}
 } audio_block_t;
 
+// helpers for the float engine (see teensy::FloatEngineScope), which converts int16 blocks to float at each object's
+// input and back at its output. Packed SSE2 conversions, so 4 samples take a handful of instructions.
+// loads 4 consecutive samples, in int16 units
+inline rack::simd::float_4 loadBlockSamples(const int16_t* data) {
+	const __m128i x = _mm_loadl_epi64((const __m128i*) data);
+	// sign extend to 32 bits, by unpacking each sample into the high half and shifting it back down
+	return rack::simd::float_4(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)));
+}
+
+// saturates 4 samples (in int16 units) and stores them, truncating towards zero
+inline void storeBlockSamples(int16_t* data, rack::simd::float_4 x) {
+	// clamp before converting, as out of range floats convert to INT32_MIN
+	const __m128i samples = _mm_cvttps_epi32(rack::simd::clamp(x, -32768.f, 32767.f).v);
+	_mm_storel_epi64((__m128i*) data, _mm_packs_epi32(samples, samples));
+}
+
 enum WaveformType {
 	WAVEFORM_SINE,
 	WAVEFORM_SAWTOOTH,
@@ -83,36 +99,146 @@ const int16_t AudioWaveformSine[257] = {
 
 namespace teensy {
 
-static uint32_t seed;
-
-inline int32_t random_teensy(void) {
-	int32_t hi, lo, x;
-
-	// the algorithm used in avr-libc 1.6.4
-	x = seed;
-	if (x == 0)
-		x = 123459876;
-	hi = x / 127773;
-	lo = x % 127773;
-	x = 16807 * lo - 2836 * hi;
-	if (x < 0)
-		x += 0x7FFFFFFF;
-	seed = x;
-	return x;
+// sample rate the audio objects are rendered at, for the calling thread (0 means use the engine sample rate)
+inline float& renderSampleRateOverride() {
+	static thread_local float sampleRate = 0.f;
+	return sampleRate;
 }
 
-inline uint32_t random_teensy(uint32_t howbig) {
-	if (howbig == 0)
-		return 0;
-	return random_teensy() % howbig;
+// audio objects should use this (rather than the engine sample rate) when deriving coefficients, as
+// the host module may choose to render them at a fixed rate (AUDIO_SAMPLE_RATE_EXACT) and resample
+inline float getSampleRate() {
+	const float sampleRate = renderSampleRateOverride();
+	return (sampleRate > 0.f) ? sampleRate : APP->engine->getSampleRate();
 }
 
-inline int32_t random_teensy(int32_t howsmall, int32_t howbig) {
-	if (howsmall >= howbig)
-		return howsmall;
-	int32_t diff = howbig - howsmall;
-	return random_teensy(diff) + howsmall;
+// while in scope, audio objects on this thread are rendered at the given sample rate
+struct RenderSampleRateScope {
+	explicit RenderSampleRateScope(float sampleRate) : previous(renderSampleRateOverride()) {
+		renderSampleRateOverride() = sampleRate;
+	}
+	~RenderSampleRateScope() {
+		renderSampleRateOverride() = previous;
+	}
+	RenderSampleRateScope(const RenderSampleRateScope&) = delete;
+	RenderSampleRateScope& operator=(const RenderSampleRateScope&) = delete;
+private:
+	const float previous;
+};
+
+// whether audio objects on the calling thread use the float engine (see FloatEngineScope)
+inline bool& floatEngineEnabled() {
+	static thread_local bool enabled = false;
+	return enabled;
 }
+
+inline bool useFloatEngine() {
+	return floatEngineEnabled();
+}
+
+// By default the audio objects emulate the Teensy's fixed-point arithmetic (see dspinst.h), which is bit-compatible
+// with the hardware. While in scope (with enabled = true), the waveform, mixer, amplifier, multiply and state variable
+// filter objects on this thread instead use float32 SIMD kernels, which are faster on desktop CPUs but not bit-exact.
+struct FloatEngineScope {
+	explicit FloatEngineScope(bool enabled) : previous(floatEngineEnabled()) {
+		floatEngineEnabled() = enabled;
+	}
+	~FloatEngineScope() {
+		floatEngineEnabled() = previous;
+	}
+	FloatEngineScope(const FloatEngineScope&) = delete;
+	FloatEngineScope& operator=(const FloatEngineScope&) = delete;
+private:
+	const bool previous;
+};
+
+// Per-instance random number generator, used by all noise sources (so there is no shared state between
+// module instances, which may be processed on different threads). This is xoshiro128+ with 4 independent
+// lanes stored as structure-of-arrays, so that filling a block vectorises. Lanes are seeded from Rack's
+// random generator, see https://prng.di.unimi.it/
+class BlockRandom {
+public:
+	static const int LANES = 4;
+
+	BlockRandom() {
+		seed(rack::random::u64());
+	}
+
+	void seed(uint64_t x) {
+		for (int lane = 0; lane < LANES; lane++) {
+			const uint64_t a = splitmix64(x), b = splitmix64(x);
+			s0[lane] = a;
+			s1[lane] = a >> 32;
+			s2[lane] = b;
+			s3[lane] = b >> 32;
+			// all zero state is invalid
+			if ((s0[lane] | s1[lane] | s2[lane] | s3[lane]) == 0) {
+				s0[lane] = 1;
+			}
+		}
+		cacheIndex = LANES;
+	}
+
+	// fills data with n uniformly distributed 32 bit values, n must be a multiple of LANES. The lowest bits of
+	// xoshiro128+ are weak (the lowest is an LFSR), so callers needing fewer bits should take the top ones.
+	void fill(uint32_t* data, int n) {
+		for (int i = 0; i < n; i += LANES) {
+			step(data + i);
+		}
+	}
+
+	// fills data with n uniformly distributed values on [0, 1), n must be a multiple of LANES
+	void fillUniform(float* data, int n) {
+		uint32_t x[LANES];
+		for (int i = 0; i < n; i += LANES) {
+			step(x);
+			for (int lane = 0; lane < LANES; lane++) {
+				data[i + lane] = (x[lane] >> 8) * (1.f / 16777216.f);
+			}
+		}
+	}
+
+	// single value, for occasional use (e.g. sample and hold)
+	uint32_t next() {
+		if (cacheIndex == LANES) {
+			step(cache);
+			cacheIndex = 0;
+		}
+		return cache[cacheIndex++];
+	}
+
+	// uniform on [0, howbig), as per Arduino random(howbig) (and 0 if howbig is 0). Multiply-shift takes the range
+	// from the top bits, rather than the weak low bits as modulo would.
+	uint32_t next(uint32_t howbig) {
+		return ((uint64_t) next() * howbig) >> 32;
+	}
+
+private:
+
+	void step(uint32_t* out) {
+		for (int lane = 0; lane < LANES; lane++) {
+			out[lane] = s0[lane] + s3[lane];
+			const uint32_t t = s1[lane] << 9;
+			s2[lane] ^= s0[lane];
+			s3[lane] ^= s1[lane];
+			s1[lane] ^= s2[lane];
+			s0[lane] ^= s3[lane];
+			s2[lane] ^= t;
+			s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+		}
+	}
+
+	static uint64_t splitmix64(uint64_t& x) {
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	uint32_t s0[LANES], s1[LANES], s2[LANES], s3[LANES];
+	uint32_t cache[LANES];
+	int cacheIndex = LANES;
+};
 }
 
 
@@ -126,26 +252,30 @@ public:
 		level_ = level;
 	}
 
-	// uniform on [-1, 1]
+	// uniform on [-1, 1)
 	float process() {
-		return level_ * ((rand31pm_next() / 2147483647.0) * 2.f - 1.f);
+		return level_ * (nextUniform() * 2.f - 1.f);
 	}
 
-	// uniform on [0, 1]
+	// uniform on [0, 1)
 	float processNonnegative() {
-		return level_ * (rand31pm_next() / 2147483647.0);
+		return level_ * nextUniform();
 	}
 
-	long unsigned int rand31pm_next() {
-		double const a = 16807;
-		double const m = 2147483647.0  ;
-
-		return (seed31pm = (long)(fmod((seed31pm * a), m)));
+private:
+	// random values are generated a block at a time
+	float nextUniform() {
+		if (index == AUDIO_BLOCK_SAMPLES) {
+			random.fillUniform(uniform, AUDIO_BLOCK_SAMPLES);
+			index = 0;
+		}
+		return uniform[index++];
 	}
 
-private:
 	float level_ = 1.0;
-	long unsigned int seed31pm  = 1;
+	teensy::BlockRandom random;
+	float uniform[AUDIO_BLOCK_SAMPLES];
+	int index = AUDIO_BLOCK_SAMPLES;
 };
 
 
@@ -42,7 +42,7 @@ public:
 	}
 	void sampleRate(float hz) {
 		// modification to account for Rack sample rate
-		int n = (APP->engine->getSampleRate() / hz) + 0.5f;
+		int n = (teensy::getSampleRate() / hz) + 0.5f;
 		if (n < 1)
 			n = 1;
 		else if (n > 64)
@@ -91,7 +91,7 @@ bool AudioEffectFlange::begin(short* delayline, int d_length, int delay_offset,
 	// initial index
 	l_delay_rate_index = 0;
 	l_circ_idx = 0;
-	delay_rate_incr = (delay_rate * 2147483648.0) / APP->engine->getSampleRate();
+	delay_rate_incr = (delay_rate * 2147483648.0) / teensy::getSampleRate();
 
 
 	delay_offset_idx = delay_offset;
@@ -113,7 +113,7 @@ bool AudioEffectFlange::voices(int delay_offset, int d_depth, float delay_rate)
 
 	delay_depth = d_depth;
 
-	delay_rate_incr = (delay_rate * 2147483648.0) / APP->engine->getSampleRate();
+	delay_rate_incr = (delay_rate * 2147483648.0) / teensy::getSampleRate();
 
 	delay_offset_idx = delay_offset;
 	// Allow the passthru code to go through
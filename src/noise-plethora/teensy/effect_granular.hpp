@@ -41,13 +41,13 @@ public:
 	void beginFreeze(float grain_length) {
 		if (grain_length <= 0.0f)
 			return;
-		beginFreeze_int(grain_length * (APP->engine->getSampleRate() * 0.001f) + 0.5f);
+		beginFreeze_int(grain_length * (teensy::getSampleRate() * 0.001f) + 0.5f);
 	}
 
 	void beginPitchShift(float grain_length) {
 		if (grain_length <= 0.0f)
 			return;
-		beginPitchShift_int(grain_length * (APP->engine->getSampleRate() * 0.001f) + 0.5f);
+		beginPitchShift_int(grain_length * (teensy::getSampleRate() * 0.001f) + 0.5f);
 	}
 
 	void stop();
@@ -40,6 +40,13 @@ void AudioEffectMultiply::update(const audio_block_t* blocka, const audio_block_
 	pb = (blockb->data);
 	end = pa + AUDIO_BLOCK_SAMPLES;
 
+	if (teensy::useFloatEngine()) {
+		for (; pa < end; pa += 4, pb += 4, out += 4) {
+			storeBlockSamples(out, loadBlockSamples(pa) * loadBlockSamples(pb) * (1.f / 32768.f));
+		}
+		return;
+	}
+
 	while (pa < end) {
 		*out++ = (int16_t) signed_saturate_rshift(int32_t (*pa++) * int32_t (*pb++), 16, 15);
 	}
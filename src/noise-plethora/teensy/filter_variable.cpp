@@ -44,6 +44,78 @@
 // no audible difference.
 //#define IMPROVE_EXPONENTIAL_ACCURACY
 
+// the same 2X oversampled Chamberlin filter as below, in float
+// returns the 2X oversampled outputs averaged, as per the fixed-point version
+static inline void processStateVariableFloat(float input, float& inputprev, float& lowpass, float& bandpass,
+    float fmult, float damp, float& lp, float& bp, float& hp) {
+	lowpass = lowpass + fmult * bandpass;
+	float highpass = 0.5f * (input + inputprev) - lowpass - damp * bandpass;
+	inputprev = input;
+	bandpass = bandpass + fmult * highpass;
+	const float lowpasstmp = lowpass;
+	const float bandpasstmp = bandpass;
+	const float highpasstmp = highpass;
+	lowpass = lowpass + fmult * bandpass;
+	highpass = input - lowpass - damp * bandpass;
+	bandpass = bandpass + fmult * highpass;
+	lp = 0.5f * (lowpass + lowpasstmp);
+	bp = 0.5f * (bandpass + bandpasstmp);
+	hp = 0.5f * (highpass + highpasstmp);
+}
+
+void AudioFilterStateVariable::update_fixed_float(const int16_t* in, int16_t* lp, int16_t* bp, int16_t* hp) {
+	const float fmult = setting_fmult_float;
+	const float damp = setting_damp_float;
+	float inputprev = state_inputprev_float;
+	float lowpass = state_lowpass_float;
+	float bandpass = state_bandpass_float;
+
+	// the filter is recursive so runs sample-by-sample, but the int16 conversions (loads, saturation and stores) are
+	// packed, 4 samples at a time
+	for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i += 4) {
+		rack::simd::float_4 input = loadBlockSamples(in + i);
+		rack::simd::float_4 lowpassOut, bandpassOut, highpassOut;
+		for (int j = 0; j < 4; j++) {
+			processStateVariableFloat(input.s[j], inputprev, lowpass, bandpass, fmult, damp,
+			                          lowpassOut.s[j], bandpassOut.s[j], highpassOut.s[j]);
+		}
+		storeBlockSamples(lp + i, lowpassOut);
+		storeBlockSamples(bp + i, bandpassOut);
+		storeBlockSamples(hp + i, highpassOut);
+	}
+	state_inputprev_float = inputprev;
+	state_lowpass_float = lowpass;
+	state_bandpass_float = bandpass;
+}
+
+void AudioFilterStateVariable::update_variable_float(const int16_t* in, const int16_t* ctl, int16_t* lp, int16_t* bp, int16_t* hp) {
+	const float damp = setting_damp_float;
+	// same upper limit on fmult as the fixed-point version, (5378279 << 8) / 2^30
+	const float maxFmult = 1.2823f;
+	float inputprev = state_inputprev_float;
+	float lowpass = state_lowpass_float;
+	float bandpass = state_bandpass_float;
+
+	for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i += 4) {
+		// corner frequency is Fcenter * 2^(control * N), control has 15 fractional bits
+		rack::simd::float_4 octaves = loadBlockSamples(ctl + i) * (setting_octavemult_float / 32768.f);
+		rack::simd::float_4 fmult = rack::simd::fmin(setting_fcenter_float * rack::dsp::approxExp2_taylor5(octaves), maxFmult);
+
+		rack::simd::float_4 input = loadBlockSamples(in + i);
+		rack::simd::float_4 lowpassOut, bandpassOut, highpassOut;
+		for (int j = 0; j < 4; j++) {
+			processStateVariableFloat(input.s[j], inputprev, lowpass, bandpass, fmult.s[j], damp,
+			                          lowpassOut.s[j], bandpassOut.s[j], highpassOut.s[j]);
+		}
+		storeBlockSamples(lp + i, lowpassOut);
+		storeBlockSamples(bp + i, bandpassOut);
+		storeBlockSamples(hp + i, highpassOut);
+	}
+	state_inputprev_float = inputprev;
+	state_lowpass_float = lowpass;
+	state_bandpass_float = bandpass;
+}
+
 
 void AudioFilterStateVariable::update_fixed(const int16_t* in, int16_t* lp, int16_t* bp, int16_t* hp) {
 	const int16_t* end = in + AUDIO_BLOCK_SAMPLES;
@@ -37,12 +37,16 @@ public:
 		state_inputprev = 0;
 		state_lowpass = 0;
 		state_bandpass = 0;
+		state_inputprev_float = 0.f;
+		state_lowpass_float = 0.f;
+		state_bandpass_float = 0.f;
+		state_is_float = false;
 	}
 	void frequency(float freq) {
 		// for reproducibility, max frequency cuts out at 2/5 Teensy sample rate 
 		// (unless we're running at very low sample rates, in which case make sure we don't allow unstable f_c)
 		const float minFrequency = 20.f;
-		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate()) / 2.5f;
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, teensy::getSampleRate()) / 2.5f;
 
 		if (freq < minFrequency) {
 			freq = minFrequency;
@@ -50,12 +54,15 @@ public:
 		else if (freq > maxFrequency) {		
 			freq = maxFrequency;
 		}
-		setting_fcenter = (freq * (3.141592654f / (APP->engine->getSampleRate() * 2.0f)))
+		setting_fcenter = (freq * (3.141592654f / (teensy::getSampleRate() * 2.0f)))
 		                  * 2147483647.0f;
 		// TODO: should we use an approximation when freq is not a const,
 		// so the sinf() function isn't linked?
-		setting_fmult = sinf(freq * (3.141592654f / (APP->engine->getSampleRate() * 2.0f)))
+		setting_fmult = sinf(freq * (3.141592654f / (teensy::getSampleRate() * 2.0f)))
 		                * 2147483647.0f;
+		// float equivalents, i.e. setting / 2^30 as used by MULT()
+		setting_fcenter_float = 2.0f * freq * (3.141592654f / (teensy::getSampleRate() * 2.0f));
+		setting_fmult_float = 2.0f * sinf(freq * (3.141592654f / (teensy::getSampleRate() * 2.0f)));
 	}
 	void resonance(float q) {
 		if (q < 0.7f)
@@ -64,6 +71,7 @@ public:
 			q = 5.0f;
 		// TODO: allow lower Q when frequency is lower
 		setting_damp = (1.0f / q) * 1073741824.0f;
+		setting_damp_float = 1.0f / q;
 	}
 	void octaveControl(float n) {
 		// filter's corner frequency is Fcenter * 2^(control * N)
@@ -74,23 +82,41 @@ public:
 		else if (n > 6.9999f)
 			n = 6.9999f;
 		setting_octavemult = n * 4096.0f;
+		setting_octavemult_float = n;
 	}
 
 	void update(const audio_block_t* input_block, const audio_block_t* control_block,
 	            audio_block_t* lowpass_block, audio_block_t* bandpass_block, audio_block_t* highpass_block) {
 
+		const bool useFloat = teensy::useFloatEngine();
+		if (useFloat != state_is_float) {
+			convert_state(useFloat);
+		}
+
 		if (control_block) {
-			update_variable(input_block->data,
-			                control_block->data,
-			                lowpass_block->data,
-			                bandpass_block->data,
-			                highpass_block->data);
+			if (useFloat) {
+				update_variable_float(input_block->data, control_block->data,
+				                      lowpass_block->data, bandpass_block->data, highpass_block->data);
+			}
+			else {
+				update_variable(input_block->data,
+				                control_block->data,
+				                lowpass_block->data,
+				                bandpass_block->data,
+				                highpass_block->data);
+			}
 		}
 		else {
-			update_fixed(input_block->data,
-			             lowpass_block->data,
-			             bandpass_block->data,
-			             highpass_block->data);
+			if (useFloat) {
+				update_fixed_float(input_block->data,
+				                   lowpass_block->data, bandpass_block->data, highpass_block->data);
+			}
+			else {
+				update_fixed(input_block->data,
+				             lowpass_block->data,
+				             bandpass_block->data,
+				             highpass_block->data);
+			}
 		}
 		return;
 	}
@@ -98,6 +124,24 @@ public:
 private:
 	void update_fixed(const int16_t* in, int16_t* lp, int16_t* bp, int16_t* hp);
 	void update_variable(const int16_t* in, const int16_t* ctl, int16_t* lp, int16_t* bp, int16_t* hp);
+	void update_fixed_float(const int16_t* in, int16_t* lp, int16_t* bp, int16_t* hp);
+	void update_variable_float(const int16_t* in, const int16_t* ctl, int16_t* lp, int16_t* bp, int16_t* hp);
+
+	// carries the filter state over when switching engine, fixed-point state is in int16 units << 12
+	void convert_state(bool toFloat) {
+		if (toFloat) {
+			state_inputprev_float = state_inputprev / 4096.f;
+			state_lowpass_float = state_lowpass / 4096.f;
+			state_bandpass_float = state_bandpass / 4096.f;
+		}
+		else {
+			state_inputprev = rack::math::clamp(state_inputprev_float * 4096.f, -2147483648.f, 2147483520.f);
+			state_lowpass = rack::math::clamp(state_lowpass_float * 4096.f, -2147483648.f, 2147483520.f);
+			state_bandpass = rack::math::clamp(state_bandpass_float * 4096.f, -2147483648.f, 2147483520.f);
+		}
+		state_is_float = toFloat;
+	}
+
 	int32_t setting_fcenter;
 	int32_t setting_fmult;
 	int32_t setting_octavemult;
@@ -105,4 +149,14 @@ private:
 	int32_t state_inputprev;
 	int32_t state_lowpass;
 	int32_t state_bandpass;
+
+	// settings and state for the float engine (see teensy::FloatEngineScope), signals are in int16 units
+	float setting_fcenter_float;
+	float setting_fmult_float;
+	float setting_octavemult_float;
+	float setting_damp_float;
+	float state_inputprev_float;
+	float state_lowpass_float;
+	float state_bandpass_float;
+	bool state_is_float;	// which of the two states above is current
 };
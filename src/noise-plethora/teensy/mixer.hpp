@@ -59,8 +59,10 @@ static void applyGainThenAdd(int16_t* dst, const int16_t* src, int32_t mult) {
 class AudioMixer4 : public AudioStream {
 public:
 	AudioMixer4(void) : AudioStream(4) {
-		for (int i = 0; i < 4; i++)
+		for (int i = 0; i < 4; i++) {
 			multiplier[i] = 256;
+			gainFloat[i] = 1.f;
+		}
 	}
 
 	void update(const audio_block_t* in1, const audio_block_t* in2, const audio_block_t* in3, const audio_block_t* in4, audio_block_t* out) {
@@ -68,11 +70,25 @@ public:
 		if (!out) {
 			return;
 		}
-		else {
-			// zero buffer before processing
-			out->zeroAudioBlock();
+
+		if (teensy::useFloatEngine()) {
+			// sum all inputs in float, saturating once per sample rather than after each input
+			const audio_block_t* in[4] = {in1, in2, in3, in4};
+			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i += 4) {
+				rack::simd::float_4 sum = 0.f;
+				for (int channel = 0; channel < 4; channel++) {
+					if (in[channel]) {
+						sum += loadBlockSamples(in[channel]->data + i) * gainFloat[channel];
+					}
+				}
+				storeBlockSamples(out->data + i, sum);
+			}
+			return;
 		}
 
+		// zero buffer before processing
+		out->zeroAudioBlock();
+
 		if (in1) {
 			applyGainThenAdd(out->data, in1->data, multiplier[0]);
 		}
@@ -95,9 +111,12 @@ public:
 		else if (gain < -127.0f)
 			gain = -127.0f;
 		multiplier[channel] = gain * 256.0f; // TODO: proper roundoff?
+		// use the same quantised gain as the fixed-point path
+		gainFloat[channel] = multiplier[channel] / 256.0f;
 	}
 private:
-	int16_t multiplier[4];	
+	int16_t multiplier[4];
+	float gainFloat[4];
 };
 
 
@@ -114,6 +133,17 @@ public:
 
 		int32_t mult = multiplier;
 
+		if (teensy::useFloatEngine()) {
+			if (mult == 65536) {
+				return;
+			}
+			const float gainFloat = mult / 65536.0f;
+			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i += 4) {
+				storeBlockSamples(block->data + i, loadBlockSamples(block->data + i) * gainFloat);
+			}
+			return;
+		}
+
 		if (mult == 0) {
 			// zero gain, discard any input and transmit nothing
 			memset(block->data, 0, sizeof(int16_t) * AUDIO_BLOCK_SAMPLES);
@@ -35,7 +35,7 @@ public:
 
 		// for reproducibility, max frequency cuts out at 1/2 Teensy sample rate
 		// (unless we're running at very low sample rates, in which case use those to limit range)
-		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate()) / 4.0f;
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, teensy::getSampleRate()) / 4.0f;
 
 		if (freq < 1.0) {
 			freq = 1.0;
@@ -44,7 +44,7 @@ public:
 			freq = maxFrequency;
 		}
 		//phase_increment = freq * (4294967296.0f / AUDIO_SAMPLE_RATE_EXACT);
-		duration = (APP->engine->getSampleRate() * 65536.0f + freq) / (freq * 2.0f);
+		duration = (teensy::getSampleRate() * 65536.0f + freq) / (freq * 2.0f);
 	}
 	void amplitude(float n) {
 		if (n < 0.0f)
@@ -40,13 +40,13 @@ public:
 		
 		// for reproducibility, max frequency cuts out at 1/2 Teensy sample rate
 		// (unless we're running at very low sample rates, in which case use those to limit range)
-		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate()) / 2.0f;
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, teensy::getSampleRate()) / 2.0f;
 
 		if (freq < 0.0f)
 			freq = 0.0;
 		else if (freq > maxFrequency)
 			freq = maxFrequency;
-		phase_increment = freq * (4294967296.0f / APP->engine->getSampleRate());
+		phase_increment = freq * (4294967296.0f / teensy::getSampleRate());
 	}
 	void phase(float angle) {
 		if (angle < 0.0f)
@@ -108,13 +108,13 @@ public:
 
 		// for reproducibility, max frequency cuts out at 1/4 Teensy sample rate
 		// (unless we're running at very low sample rates, in which case use those to limit range)
-		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate()) / 4.0f;
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, teensy::getSampleRate()) / 4.0f;
 
 		if (freq < 0.0f)
 			freq = 0.0f;
 		else if (freq > maxFrequency)
 			freq = maxFrequency;
-		phase_increment = freq * (4294967296.0f / APP->engine->getSampleRate());
+		phase_increment = freq * (4294967296.0f / teensy::getSampleRate());
 	}
 	void phase(float angle) {
 		if (angle < 0.0f)
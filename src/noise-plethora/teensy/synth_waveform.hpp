@@ -15,7 +15,7 @@ public:
 
 		// for reproducibility, max frequency cuts out at 1/2 Teensy sample rate
 		// (unless we're running at very low sample rates, in which case use those to limit range)
-		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate()) / 2.0f;
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, teensy::getSampleRate()) / 2.0f;
 
 		if (freq < 0.0f) {
 			freq = 0.0;
@@ -23,7 +23,7 @@ public:
 		else if (freq > maxFrequency) {
 			freq = maxFrequency;
 		}
-		phase_increment = freq * (4294967296.0f / APP->engine->getSampleRate());
+		phase_increment = freq * (4294967296.0f / teensy::getSampleRate());
 		if (phase_increment > 0x7FFE0000u)
 			phase_increment = 0x7FFE0000;
 	}
@@ -98,6 +98,10 @@ public:
 			phase_accumulator += inc * AUDIO_BLOCK_SAMPLES;
 			return;
 		}
+		if (teensy::useFloatEngine() && update_float(block)) {
+			return;
+		}
+
 		bp = block->data;
 
 		switch (tone_type) {
@@ -215,7 +219,7 @@ public:
 					*bp++ = sample;
 					uint32_t newph = ph + inc;
 					if (newph < ph) {
-						sample = teensy::random_teensy(magnitude) - (magnitude >> 1);
+						sample = random.next(magnitude) - (magnitude >> 1);
 					}
 					ph = newph;
 				}
@@ -234,6 +238,81 @@ public:
 	}
 
 private:
+	// float engine version of update(), 4 samples at a time, for the basic waveforms (returns false, having
+	// done nothing, for the remaining waveforms which then use the fixed-point version)
+	bool update_float(audio_block_t* block) {
+		using rack::simd::float_4;
+
+		// copied to locals, as the int16 stores to the block could otherwise alias them (so they'd be reloaded
+		// every 4 samples, and the switch below couldn't be hoisted out of the loop)
+		const short type = tone_type;
+		const float offset = tone_offset;
+
+		switch (type) {
+			case WAVEFORM_SINE:
+			case WAVEFORM_SAWTOOTH:
+			case WAVEFORM_SAWTOOTH_REVERSE:
+			case WAVEFORM_SQUARE:
+			case WAVEFORM_PULSE:
+			case WAVEFORM_TRIANGLE:
+				break;
+			default:
+				return false;
+		}
+
+		const uint32_t inc = phase_increment;
+		uint32_t ph = phase_accumulator + phase_offset;
+
+		// same scaling as the fixed-point version, in int16 units
+		const float sawMagnitude = (type == WAVEFORM_SAWTOOTH_REVERSE) ? (int32_t)(0xFFFFFFFFu - magnitude) : magnitude;
+		const float magnitude15 = signed_saturate_rshift(magnitude, 16, 1);
+		const float sineMagnitude = magnitude * (32767.f / 65536.f);
+		// pulse width as a fraction of a cycle
+		const float width = (pulse_width >> 8) * (1.f / 16777216.f);
+
+		// phase accumulator offsets of the 4 samples, added (wrapping, as the accumulator does) with integer SIMD
+		const __m128i phaseOffsets = _mm_setr_epi32(0, (int32_t) inc, (int32_t)(2 * inc), (int32_t)(3 * inc));
+
+		for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i += 4) {
+			// phase as a fraction of a cycle, in [-0.5, 0.5) (i.e. the phase accumulator read as signed)
+			const __m128i phases = _mm_add_epi32(_mm_set1_epi32((int32_t) ph), phaseOffsets);
+			const float_4 phase = float_4(_mm_cvtepi32_ps(phases)) * (1.f / 4294967296.f);
+			ph += 4 * inc;
+
+			float_4 out;
+			switch (type) {
+				case WAVEFORM_SINE:
+					out = rack::simd::sin(phase * (float)(2 * M_PI)) * sineMagnitude;
+					break;
+				case WAVEFORM_SAWTOOTH:
+				case WAVEFORM_SAWTOOTH_REVERSE:
+					out = phase * sawMagnitude;
+					break;
+				case WAVEFORM_SQUARE:
+					out = rack::simd::ifelse(phase < 0.f, -magnitude15, magnitude15);
+					break;
+				case WAVEFORM_PULSE: {
+					// compare as unsigned phase, in [0, 1)
+					const float_4 unsignedPhase = phase + rack::simd::ifelse(phase < 0.f, 1.f, 0.f);
+					out = rack::simd::ifelse(unsignedPhase < width, magnitude15, -magnitude15);
+					break;
+				}
+				default: {
+					// WAVEFORM_TRIANGLE, peaks (of +/-magnitude / 2) at phase +/-0.25
+					const float_4 ramp = 2.f * phase;
+					out = rack::simd::ifelse(phase > 0.25f, 1.f - ramp, rack::simd::ifelse(phase < -0.25f, -1.f - ramp, ramp));
+					out *= magnitude;
+					break;
+				}
+			}
+
+			storeBlockSamples(block->data + i, out + offset);
+		}
+		phase_accumulator = ph - phase_offset;
+
+		return true;
+	}
+
 	uint32_t phase_accumulator;
 	uint32_t phase_increment;
 	uint32_t phase_offset;
@@ -241,6 +320,7 @@ private:
 	uint32_t pulse_width;
 	const int16_t* arbdata;
 	int16_t  sample; // for WAVEFORM_SAMPLE_HOLD
+	teensy::BlockRandom random; // for WAVEFORM_SAMPLE_HOLD
 	short    tone_type;
 	int16_t  tone_offset;
 };
@@ -257,7 +337,7 @@ public:
 
 		// for reproducibility, max frequency cuts out at 1/2 Teensy sample rate
 		// (unless we're running at very low sample rates, in which case use those to limit range)
-		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, APP->engine->getSampleRate()) / 2.0f;
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, teensy::getSampleRate()) / 2.0f;
 
 		if (freq < 0.0f) {
 			freq = 0.0;
@@ -265,7 +345,7 @@ public:
 		else if (freq > maxFrequency) {
 			freq = maxFrequency;
 		}
-		phase_increment = freq * (4294967296.0f / APP->engine->getSampleRate());
+		phase_increment = freq * (4294967296.0f / teensy::getSampleRate());
 		if (phase_increment > 0x7FFE0000u)
 			phase_increment = 0x7FFE0000;
 	}
@@ -511,7 +591,7 @@ public:
 				for (i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
 					ph = phasedata[i];
 					if (ph < priorphase) { // does not work for phase modulation
-						sample = teensy::random_teensy(magnitude) - (magnitude >> 1);
+						sample = random.next(magnitude) - (magnitude >> 1);
 					}
 					priorphase = ph;
 					*bp++ = sample;
@@ -545,6 +625,7 @@ private:
 	uint32_t phasedata[AUDIO_BLOCK_SAMPLES];
 
 	int16_t  sample; // for WAVEFORM_SAMPLE_HOLD
+	teensy::BlockRandom random; // for WAVEFORM_SAMPLE_HOLD
 	int16_t  tone_offset;
 	uint8_t  tone_type;
 	uint8_t  modulation_type;
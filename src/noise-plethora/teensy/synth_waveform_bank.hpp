@@ -0,0 +1,262 @@
+#pragma once
+
+#include "audio_core.hpp"
+
+// A bank of N oscillators that are rendered and summed in a single pass, for the "cluster" algorithms which would
+// otherwise run N AudioSynthWaveformModulated objects into a tree of unity gain AudioMixer4s. Oscillator state is
+// stored as structure-of-arrays so that the per-oscillator work within a sample can be vectorised, and with a shared
+// FM input the exp2 is evaluated once per sample for the whole bank, rather than once per oscillator.
+//
+// The waveform kernels are those of AudioSynthWaveformModulated (Teensy Audio Library, (c) Paul Stoffregen), and
+// oscillators are summed in groups of four as the mixer tree would (saturating after each addition), so output is
+// bit-identical to the equivalent graph. Supported waveforms are sine, sawtooth (and reverse), square, triangle
+// and pulse - pulse width is taken from the shape input if connected, otherwise from pulseWidth(). As with
+// AudioSynthWaveformModulated, WAVEFORM_TRIANGLE_VARIABLE without a shape input is a plain triangle. Other
+// waveform types render silence.
+template <int N>
+class AudioSynthWaveformBank : public AudioStream {
+public:
+	AudioSynthWaveformBank() : AudioStream(2), modulation_factor(32768), tone_type(WAVEFORM_SINE) {
+		for (int k = 0; k < N; k++) {
+			phase_accumulator[k] = 0;
+			phase_increment[k] = 0;
+			magnitude[k] = 0;
+			pulse_width[k] = 0x80000000u;
+		}
+	}
+
+	void frequency(int osc, float freq) {
+		// for reproducibility, max frequency cuts out at 1/2 Teensy sample rate
+		// (unless we're running at very low sample rates, in which case use those to limit range)
+		const float maxFrequency = std::min(AUDIO_SAMPLE_RATE_EXACT, teensy::getSampleRate()) / 2.0f;
+
+		if (freq < 0.0f) {
+			freq = 0.0;
+		}
+		else if (freq > maxFrequency) {
+			freq = maxFrequency;
+		}
+		phase_increment[osc] = freq * (4294967296.0f / teensy::getSampleRate());
+		if (phase_increment[osc] > 0x7FFE0000u)
+			phase_increment[osc] = 0x7FFE0000;
+	}
+	void amplitude(int osc, float n) {	// 0 to 1.0
+		if (n < 0) {
+			n = 0;
+		}
+		else if (n > 1.0f) {
+			n = 1.0f;
+		}
+		magnitude[osc] = n * 65536.0f;
+	}
+	// only used by WAVEFORM_PULSE when there is no shape input
+	void pulseWidth(int osc, float n) {	// 0.0 to 1.0
+		if (n < 0) {
+			n = 0;
+		}
+		else if (n > 1.0f) {
+			n = 1.0f;
+		}
+		pulse_width[osc] = n * 4294967296.0f;
+	}
+	// waveform type is shared by all oscillators
+	void begin(short t_type) {
+		tone_type = t_type;
+	}
+	void begin(int osc, float t_amp, float t_freq, short t_type) {
+		amplitude(osc, t_amp);
+		frequency(osc, t_freq);
+		begin(t_type);
+	}
+	void frequencyModulation(float octaves) {
+		if (octaves > 12.0f) {
+			octaves = 12.0f;
+		}
+		else if (octaves < 0.1f) {
+			octaves = 0.1f;
+		}
+		modulation_factor = octaves * 4096.0f;
+	}
+
+	// renders all oscillators, summed into block, with moddata (if not null) frequency modulating every oscillator
+	void update(const audio_block_t* moddata, const audio_block_t* shapedata, audio_block_t* block) {
+		if (!block) {
+			return;
+		}
+
+		if (moddata) {
+			for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+				const uint32_t scale = modulationScale(moddata->data[i]);
+				for (int k = 0; k < N; k++) {
+					phase_accumulator[k] += modulatedIncrement(phase_increment[k], scale);
+					phasedata[i][k] = phase_accumulator[k];
+				}
+			}
+		}
+		else {
+			computeUnmodulatedPhases();
+		}
+
+		render(shapedata, block);
+	}
+
+	// as above, but oscillator k is frequency modulated by moddata[k]
+	void updateWithModulators(const audio_block_t (&moddata)[N], const audio_block_t* shapedata, audio_block_t* block) {
+		if (!block) {
+			return;
+		}
+
+		for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (int k = 0; k < N; k++) {
+				phase_accumulator[k] += modulatedIncrement(phase_increment[k], modulationScale(moddata[k].data[i]));
+				phasedata[i][k] = phase_accumulator[k];
+			}
+		}
+
+		render(shapedata, block);
+	}
+
+private:
+
+	// frequency multiplier for FM input mod, 2^(mod * modulation_factor), as per AudioSynthWaveformModulated
+	uint32_t modulationScale(int16_t mod) const {
+		int32_t n = mod * (int32_t) modulation_factor; // n is # of octaves to mod
+		int32_t ipart = n >> 27; // 4 integer bits
+		n &= 0x7FFFFFF;          // 27 fractional bits
+#ifdef IMPROVE_EXPONENTIAL_ACCURACY
+		int32_t x = n << 3;
+		n = multiply_accumulate_32x32_rshift32_rounded(536870912, x, 1494202713);
+		int32_t sq = multiply_32x32_rshift32_rounded(x, x);
+		n = multiply_accumulate_32x32_rshift32_rounded(n, sq, 1934101615);
+		n = n + (multiply_32x32_rshift32_rounded(sq,
+		         multiply_32x32_rshift32_rounded(x, 1358044250)) << 1);
+		n = n << 1;
+#else
+		n = (n + 134217728) << 3;
+
+		n = multiply_32x32_rshift32_rounded(n, n);
+		n = multiply_32x32_rshift32_rounded(n, 715827883) << 3;
+		n = n + 715827882;
+#endif
+		return n >> (14 - ipart);
+	}
+
+	static uint32_t modulatedIncrement(uint32_t inc, uint32_t scale) {
+		uint64_t phstep = (uint64_t)inc * scale;
+		uint32_t phstep_msw = phstep >> 32;
+		return (phstep_msw < 0x7FFE) ? (uint32_t)(phstep >> 16) : 0x7FFE0000u;
+	}
+
+	void computeUnmodulatedPhases() {
+		for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+			for (int k = 0; k < N; k++) {
+				phasedata[i][k] = phase_accumulator[k];
+				phase_accumulator[k] += phase_increment[k];
+			}
+		}
+	}
+
+	// sums oscillator values as a tree of unity gain AudioMixer4s would, i.e. in groups of four
+	// (saturating after each addition) then the group sums (again saturating after each addition)
+	static int16_t mix(const int32_t* values) {
+		int32_t sum = 0;
+		for (int group = 0; group < N; group += 4) {
+			int32_t groupSum = 0;
+			for (int k = group; k < std::min(group + 4, N); k++) {
+				groupSum = signed_saturate_rshift(groupSum + values[k], 16, 0);
+			}
+			sum = signed_saturate_rshift(sum + groupSum, 16, 0);
+		}
+		return sum;
+	}
+
+	void render(const audio_block_t* shapedata, audio_block_t* block) {
+		int16_t* bp = block->data;
+		int32_t values[N];
+
+		switch (tone_type) {
+			case WAVEFORM_SINE:
+				for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (int k = 0; k < N; k++) {
+						const uint32_t ph = phasedata[i][k];
+						const uint32_t index = ph >> 24;
+						const uint32_t scale = (ph >> 8) & 0xFFFF;
+						const int32_t val1 = AudioWaveformSine[index] * (int32_t)(0x10000 - scale);
+						const int32_t val2 = AudioWaveformSine[index + 1] * (int32_t) scale;
+						values[k] = (int16_t) multiply_32x32_rshift32(val1 + val2, magnitude[k]);
+					}
+					*bp++ = mix(values);
+				}
+				break;
+
+			case WAVEFORM_PULSE:
+				for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (int k = 0; k < N; k++) {
+						const uint32_t width = shapedata ? ((shapedata->data[i] + 0x8000) & 0xFFFF) << 16 : pulse_width[k];
+						const int16_t magnitude15 = signed_saturate_rshift(magnitude[k], 16, 1);
+						values[k] = (phasedata[i][k] < width) ? magnitude15 : -magnitude15;
+					}
+					*bp++ = mix(values);
+				}
+				break;
+
+			case WAVEFORM_SQUARE:
+				for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (int k = 0; k < N; k++) {
+						const int16_t magnitude15 = signed_saturate_rshift(magnitude[k], 16, 1);
+						values[k] = (phasedata[i][k] & 0x80000000) ? -magnitude15 : magnitude15;
+					}
+					*bp++ = mix(values);
+				}
+				break;
+
+			case WAVEFORM_SAWTOOTH:
+				for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (int k = 0; k < N; k++) {
+						values[k] = (int16_t) signed_multiply_32x16t(magnitude[k], phasedata[i][k]);
+					}
+					*bp++ = mix(values);
+				}
+				break;
+
+			case WAVEFORM_SAWTOOTH_REVERSE:
+				for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (int k = 0; k < N; k++) {
+						values[k] = (int16_t) signed_multiply_32x16t(0xFFFFFFFFu - magnitude[k], phasedata[i][k]);
+					}
+					*bp++ = mix(values);
+				}
+				break;
+
+			case WAVEFORM_TRIANGLE_VARIABLE:
+			case WAVEFORM_TRIANGLE:
+				for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+					for (int k = 0; k < N; k++) {
+						const uint32_t ph = phasedata[i][k];
+						const uint32_t phtop = ph >> 30;
+						if (phtop == 1 || phtop == 2) {
+							values[k] = (int16_t)(((0xFFFF - (ph >> 15)) * magnitude[k]) >> 16);
+						}
+						else {
+							values[k] = (int16_t)((((int32_t)ph >> 15) * magnitude[k]) >> 16);
+						}
+					}
+					*bp++ = mix(values);
+				}
+				break;
+
+			default:
+				block->zeroAudioBlock();
+				break;
+		}
+	}
+
+	uint32_t phase_accumulator[N];
+	uint32_t phase_increment[N];
+	int32_t  magnitude[N];
+	uint32_t pulse_width[N];
+	uint32_t modulation_factor;
+	short    tone_type;
+	// phase of every oscillator for every sample of the current update, sample-major
+	uint32_t phasedata[AUDIO_BLOCK_SAMPLES][N];
+};
@@ -27,13 +27,9 @@
 
 #include "synth_whitenoise.hpp"
 
-// Park-Miller-Carta Pseudo-Random Number Generator
-// http://www.firstpr.com.au/dsp/rand31/
-
 void AudioSynthNoiseWhite::update(audio_block_t* block) {
-	uint32_t* p, *end;
-	int32_t n1, n2, gain;
-	uint32_t lo, hi;
+	int32_t gain;
+	uint32_t values[AUDIO_BLOCK_SAMPLES];
 
 	gain = level;
 	if (gain == 0)
@@ -41,31 +37,13 @@ void AudioSynthNoiseWhite::update(audio_block_t* block) {
 
 	if (!block)
 		return;
-	p = (uint32_t*)(block->data);
-	end = p + AUDIO_BLOCK_SAMPLES / 2;
-	lo = seed;
-	do {
-		uint32_t val1;
-
-		hi = 16807 * (lo >> 16);
-		lo = 16807 * (lo & 0xFFFF);
-		lo += (hi & 0x7FFF) << 16;
-		lo += hi >> 15;
-		lo = (lo & 0x7FFFFFFF) + (lo >> 31);
-		n1 = signed_multiply_32x16b(gain, lo);
-		hi = 16807 * (lo >> 16);
-		lo = 16807 * (lo & 0xFFFF);
-		lo += (hi & 0x7FFF) << 16;
-		lo += hi >> 15;
-		lo = (lo & 0x7FFFFFFF) + (lo >> 31);
-		n2 = signed_multiply_32x16b(gain, lo);
-		val1 = pack_16b_16b(n2, n1);
-		*p++ = val1;
 
-	} while (p < end);
-	seed = lo;
+	// the original uses a Park-Miller-Carta generator, here we use the (per-instance) block generator,
+	// scaling 16 bits of each value by gain as before (the top ones, as the bottom bits of xoshiro128+ are weak)
+	random.fill(values, AUDIO_BLOCK_SAMPLES);
+	for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+		block->data[i] = signed_multiply_32x16b(gain, values[i] >> 16);
+	}
 }
 
-uint16_t AudioSynthNoiseWhite::instance_count = 0;
-
 
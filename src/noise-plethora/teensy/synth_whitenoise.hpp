@@ -32,7 +32,6 @@ class AudioSynthNoiseWhite : public AudioStream {
 public:
 	AudioSynthNoiseWhite() : AudioStream(0) {
 		level = 0;
-		seed = 1 + instance_count++;
 	}
 	void amplitude(float n) {
 		if (n < 0.0f)
@@ -44,8 +43,7 @@ public:
 	virtual void update(audio_block_t* block);
 private:
 	int32_t  level; // 0=off, 65536=max
-	uint32_t seed;  // must start at 1
-	static uint16_t instance_count;
+	teensy::BlockRandom random;
 };
 
 #endif
@@ -226,8 +226,8 @@ private:
 	float envLinear = 0.f;
 };
 
-// Creates a Butterworth 2*Nth order highpass filter for blocking DC
-template<int N>
+// Creates a Butterworth 2*Nth order highpass filter for blocking DC (T may be a SIMD type, e.g. simd::float_4)
+template<int N, typename T = float>
 struct DCBlockerT {
 
 	DCBlockerT() {
@@ -240,7 +240,7 @@ struct DCBlockerT {
 		recalculateCoefficients();
 	}
 
-	float process(float x) {
+	T process(T x) {
 
 		x = blockDCFilter[0].process(x);
 		return blockDCFilter[1].process(x);
@@ -256,14 +256,14 @@ private:
 
 		for (int idx = 0; idx < N; idx++) {
 			float Q = 1.0f / (2.0f * std::cos(firstAngle + idx * poleInc));
-			blockDCFilter[idx].setParameters(dsp::BiquadFilter::HIGHPASS, fc_, Q, 1.0f);
+			blockDCFilter[idx].setParameters(dsp::TBiquadFilter<T>::HIGHPASS, fc_, Q, 1.0f);
 		}
 	}
 
 	float fc_;
 	static const int order = 2 * N;
 
-	dsp::BiquadFilter blockDCFilter[N];
+	dsp::TBiquadFilter<T> blockDCFilter[N];
 };
 
 typedef DCBlockerT<2> DCBlocker;